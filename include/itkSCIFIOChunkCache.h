@@ -0,0 +1,157 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSCIFIOChunkCache_h
+#define itkSCIFIOChunkCache_h
+
+#include "SCIFIOExport.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace itk
+{
+/** \class SCIFIOChunkCache
+ *
+ * \brief Persistent on-disk cache of decoded pixels.
+ *
+ * Each chunk is stored raw, in a file of its own in the cache directory, so
+ * that it can be memory-mapped when found again, by this process or another
+ * one. Chunks are keyed with MakeKey() by the identity of the file they come
+ * from (full path, length and modification time, to the finest resolution the
+ * platform keeps), the series and the plane, so chunks of a file that has
+ * changed are never served; they age out. Planes of file patterns are not
+ * cached, since the files of the group could change unnoticed.
+ *
+ * Chunks are written to a temporary file and renamed into place, so several
+ * processes can share a cache directory. When the chunks grow over
+ * MaximumSize, the least recently used ones are removed, as told by the
+ * modification times of their files, which Find() updates.
+ *
+ * A SCIFIOImageIO given a cache with SCIFIOImageIO::SetChunkCache() stores
+ * every plane it reads through Java, and serves later reads of those planes
+ * from the cache.
+ *
+ * \ingroup SCIFIO
+ */
+class SCIFIO_EXPORT SCIFIOChunkCache : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SCIFIOChunkCache);
+
+  using Self = SCIFIOChunkCache;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory **/
+  itkNewMacro(Self);
+
+  /** RTTI (and related methods) **/
+  itkTypeMacro(SCIFIOChunkCache, Object);
+
+  /** A chunk mapped into memory. It stays valid, even if the chunk is
+   * evicted meanwhile, until it is destroyed. */
+  class SCIFIO_EXPORT MappedChunk
+  {
+  public:
+    ITK_DISALLOW_COPY_AND_ASSIGN(MappedChunk);
+
+    MappedChunk() = default;
+    ~MappedChunk();
+
+    const char * GetData() const { return m_Data; }
+    SizeValueType GetSize() const { return m_Size; }
+
+  private:
+    friend class SCIFIOChunkCache;
+
+    void *        m_Mapping{ nullptr };
+    size_t        m_MappingSize{ 0 };
+    const char *  m_Data{ nullptr };
+    SizeValueType m_Size{ 0 };
+#ifdef _WIN32
+    void *        m_MappingHandle{ nullptr };
+#endif
+  };
+
+  using MappedChunkPointer = std::unique_ptr< MappedChunk >;
+
+  /** Directory the chunks are stored in. It is created on the first
+   * Insert() if it does not exist. */
+  itkSetStringMacro(Directory);
+  itkGetStringMacro(Directory);
+
+  /** Total size, in bytes, of the chunk files the directory may hold.
+   * Defaults to 1 GiB. */
+  itkSetMacro(MaximumSize, SizeValueType);
+  itkGetConstMacro(MaximumSize, SizeValueType);
+
+  /** Number of chunks Find() found, and did not find. */
+  itkGetConstMacro(NumberOfHits, SizeValueType);
+  itkGetConstMacro(NumberOfMisses, SizeValueType);
+
+  /** Key of a plane of a series of a file. Empty if the file does not
+   * exist or is a file pattern, so that it cannot be cached. */
+  static std::string MakeKey(const std::string & fileName, int series, SizeValueType plane);
+
+  /** Modification time of a file, to the finest resolution the platform
+   * keeps, so that a file rewritten within a second at the same length is
+   * still told apart. Empty if the file does not exist. */
+  static std::string GetModifiedTime(const std::string & fileName);
+
+  /** Length of a file, in bytes, 64-bit on every platform. */
+  static std::uint64_t GetFileLength(const std::string & fileName);
+
+  /** Map the chunk with a key, marking it as the most recently used one.
+   * Returns nullptr if the cache does not hold it. */
+  MappedChunkPointer Find(const std::string & key);
+
+  /** Store a chunk, replacing any chunk with the same key, and evict the
+   * least recently used chunks if the cache has grown over MaximumSize.
+   * Returns false, leaving the cache as it was, if the chunk could not be
+   * written. */
+  bool Insert(const std::string & key, const void * data, SizeValueType size);
+
+  /** Remove all chunks. */
+  void Clear();
+
+protected:
+  SCIFIOChunkCache() = default;
+  ~SCIFIOChunkCache() override = default;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  std::string ChunkFileName(const std::string & key) const;
+  void Evict();
+
+  std::string        m_Directory;
+  SizeValueType      m_MaximumSize{ SizeValueType(1) << 30 };
+  SizeValueType      m_NumberOfHits{ 0 };
+  SizeValueType      m_NumberOfMisses{ 0 };
+  SizeValueType      m_NumberOfInserts{ 0 };
+  long long          m_KnownSize{ -1 };
+  mutable std::mutex m_Mutex;
+};
+} // end namespace itk
+
+#endif // itkSCIFIOChunkCache_h
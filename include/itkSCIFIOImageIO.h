@@ -20,14 +20,24 @@
 
 #include "SCIFIOExport.h"
 #include "itkStreamingImageIOBase.h"
+#include "itkSCIFIOChunkCache.h"
+#include "itkSCIFIOMetadataCatalog.h"
+#include "itkSCIFIOJNIReader.h"
+#include "itkSCIFIOOMETIFFReader.h"
 
 #include "itksys/Process.h"
 #include "itksys/SystemTools.hxx"
 
+#include <chrono>
+#include <fstream>
+#include <map>
 #include <sstream>
+#include <vector>
 
 namespace itk
 {
+class SCIFIOPlaneStream;
+
 /** \class SCIFIOImageIO
  *
  * \brief Interface to the OME SCIFIO Java Library.
@@ -70,6 +80,71 @@ namespace itk
  *   execution. This is especially useful to override Java's maximum heap
  *   size, but also nice for tweaking the VM in many other ways (e.g.,
  *   garbage collection settings).
+ * - SCIFIO_TRACE - Records the exchanges of every SCIFIOImageIO with the
+ *   bridge, as with SetTraceFileName, to files named
+ *   <SCIFIO_TRACE><process id>-<instance number>.trace.
+ * - SCIFIO_BRIDGE_COMMAND - Command line of a program to run in place of
+ *   the Java bridge, such as the SCIFIOStandInBridge test program, which
+ *   serves synthetic data without Java. It is built with the tests, and
+ *   not installed.
+ * - SCIFIO_BACKEND - "jni" to read through a JVM embedded in the process
+ *   instead of a Java subprocess, as with SetBackend(JNIBackend).
+ * - SCIFIO_FILE_SUFFIXES - Comma-separated suffixes of the only file names
+ *   to read and write, as with SetAllowedFileSuffixes.
+ * - SCIFIO_CHUNK_CACHE - Directory of a SCIFIOChunkCache to read through,
+ *   holding at most SCIFIO_CHUNK_CACHE_SIZE MiB (1024 by default).
+ *
+ * SetNumberOfResolutions adds sub-resolutions to the planes written, for
+ * pyramidal OME-TIFF files, in the same pass as the full resolution. Writing
+ * them throws if the bridge does not accept them.
+ *
+ * Subsets of the Z, T and C axes, such as channels {0, 3} or every 10th
+ * timepoint, can be selected with SetIndexSelection or SetStrideSelection.
+ * The image then only has the selected planes, packed densely, and they are
+ * read with a single pipelined exchange with Java.
+ *
+ * Groups of files holding one plane or stack each, such as
+ * img_z000_t000.tif, img_z001_t000.tif, ..., are read as a single image by
+ * giving a Bio-Formats file pattern, e.g. "img_z<000-009>_t<000-004>.tif",
+ * as the file name. Bio-Formats stitches the files together, so that the
+ * image information is read once and planes of every file come through one
+ * session, with reads queued across file boundaries. FindFilePattern
+ * gives the pattern of a list of file names.
+ *
+ * One of the Z, T and C axes can be reduced to a maximum, minimum, sum or
+ * mean projection with SetProjection. The planes along it are then read
+ * and accumulated one slab at a time, so that only the projection and two
+ * slabs are ever held in memory, whatever the length of the axis. This
+ * saves memory only: the reduction runs in C++, so every plane along the
+ * axis is still read, and through the Java subprocess, still sent over its
+ * pipe.
+ *
+ * Single-file OME-TIFF datasets are read natively, without Java, by a
+ * SCIFIOOMETIFFReader, when they only use features it supports. This can
+ * be turned off with SetUseNativeOMETIFF(false).
+ *
+ * By default, SCIFIO runs in a Java subprocess, which keeps crashes and
+ * memory use of Java out of the application. When SCIFIO is built with
+ * SCIFIO_USE_JNI, SetBackend(JNIBackend) reads through a SCIFIOJNIReader
+ * instead, which embeds the JVM in the process and has Bio-Formats copy
+ * pixels straight into the output buffer. Writes always go through the
+ * subprocess.
+ *
+ * When a class-data-sharing archive of the bridge, scifio-itk-bridge.jsa,
+ * lies next to the JARs, as SCIFIO builds and installs with
+ * SCIFIO_BUILD_CDS_ARCHIVE, the JVM is started with it, to map the classes
+ * the bridge needs instead of loading them. This happens only when the
+ * JVM's release file matches the one recorded next to the archive by the
+ * JVM that dumped it.
+ *
+ * A SCIFIOMetadataCatalog can be given with SetCatalog(). Image information
+ * of the files it holds is then read from the catalog instead of Java.
+ *
+ * A SCIFIOChunkCache can be given with SetChunkCache(), or with the
+ * SCIFIO_CHUNK_CACHE environment variable. Planes read through Java are
+ * then stored in it whole, and later reads of any part of them are served
+ * from memory-mapped cache files. Reads of planes that are not cached go
+ * to Java one plane at a time.
  *
  * [scifio]:       http://openmicroscopy.org/site/support/bio-formats/developers/scifio.html
  * [bio-formats]:  http://openmicroscopy.org/site/products/bio-formats
@@ -109,6 +184,117 @@ public:
   /* Read the data from the disk into provided memory buffer */
   void Read(void* buffer) override;
 
+  /* Index of the series set with SetSeries */
+  itkGetConstMacro(Series, int);
+
+  /* Largest region of the current series, in SCIFIO's XYZTC order: always
+   * 5-D, including singleton axes. Reads the image information if needed */
+  ImageIORegion GetXYZTCLargestPossibleRegion();
+
+  /* Number of bytes ReadXYZTCRegion writes for the given region */
+  size_t GetXYZTCRegionBufferSize(const ImageIORegion & region);
+
+  /* Read a 5-D region, in XYZTC order, of the current series straight into
+   * the provided buffer, independently of the IO region. Pixels are stored
+   * with X varying fastest and components interleaved */
+  void ReadXYZTCRegion(void* buffer, const ImageIORegion & region);
+
+  /* Largest number of bytes of a plane transferred by a single read
+   * command. Larger planes are read in strips of rows. Writes of larger
+   * planes throw, as the bridge only writes whole planes. Defaults to just
+   * under 2 GiB, the most a Java array can hold */
+  itkSetMacro(MaximumTransferSize, SizeValueType);
+  itkGetConstMacro(MaximumTransferSize, SizeValueType);
+
+  /* Axes of SCIFIO's XYZTC order, for selections */
+  enum { ZAxis = 2, TAxis = 3, CAxis = 4 };
+  using IndexListType = std::vector< SizeValueType >;
+
+  /* Restrict the Z, T or C axis to the given indices, in the given order.
+   * ReadImageInformation reports the number of selected indices as the
+   * size of the axis, and Read packs the selected planes densely. An empty
+   * list selects the whole axis */
+  void SetIndexSelection(unsigned int axis, const IndexListType & indices);
+  const IndexListType & GetIndexSelection(unsigned int axis) const;
+
+  /* Select every stride-th index of the Z, T or C axis, from start up to
+   * but excluding stop */
+  void SetStrideSelection(unsigned int axis, SizeValueType start, SizeValueType stop, SizeValueType stride);
+
+  /* Select the whole of every axis again */
+  void ClearSelections();
+
+  /* Whether a file name is a Bio-Formats file pattern, with blocks such as
+   * <000-099>, <0-99:2> or <a,b,c> standing for the parts that vary */
+  static bool IsFilePattern(const std::string & fileName);
+
+  /* Bio-Formats file pattern matching exactly the given file names, which
+   * must only differ in numbers and cover every combination of them, as
+   * the files of an ImageSeriesReader usually do. Bio-Formats guesses the
+   * axis of each number from the text before it, such as z, t or c */
+  static std::string FindFilePattern(const std::vector< std::string > & fileNames);
+
+  /* Reductions of an axis to a single plane */
+  enum ProjectionType { NoProjection = 0, MaximumProjection, MinimumProjection, SumProjection, MeanProjection };
+
+  /* Project the Z, T or C axis, or its selection, if any, to a single plane
+   * with the given reduction. ReadImageInformation reports the axis with a
+   * size of 1, and the component type as double for the sum and the mean.
+   * Projected pixels are in native byte order. Every plane along the axis
+   * is still read, so this bounds memory, not the data read. NoProjection
+   * reads the axis as is again */
+  void SetProjection(ProjectionType projection, unsigned int axis);
+  itkGetConstMacro(Projection, ProjectionType);
+  itkGetConstMacro(ProjectionAxis, unsigned int);
+
+  /* Whether OME-TIFF files are read natively when possible. On by default */
+  itkSetMacro(UseNativeOMETIFF, bool);
+  itkGetConstMacro(UseNativeOMETIFF, bool);
+  itkBooleanMacro(UseNativeOMETIFF);
+
+  /* How reads reach SCIFIO: through a Java subprocess (the default), or a
+   * JVM embedded in the process through JNI, if SCIFIO was built with
+   * SCIFIO_USE_JNI */
+  enum BackendType { SubprocessBackend = 0, JNIBackend };
+  itkSetMacro(Backend, BackendType);
+  itkGetConstMacro(Backend, BackendType);
+
+  /* File to record the exchanges with the bridge to: each command, and the
+   * size of and time spent waiting for each reply, in microseconds.
+   * Recording is off when empty, the default unless SCIFIO_TRACE is set.
+   * The trace is complete once closed, by setting another file name or
+   * deleting the IO */
+  void SetTraceFileName(const std::string & traceFileName);
+  itkGetStringMacro(TraceFileName);
+
+  /* Re-issue the exchanges recorded in a trace file, with the same sizes
+   * but synthetic pixel data, and report how the time spent waiting for
+   * the bridge compares with the recording, per command. Returns the
+   * number of exchanges replayed */
+  SizeValueType ReplayTrace(const std::string & traceFileName, std::ostream & report);
+
+  /* Catalog used to answer CanReadFile, GetSeriesCount and
+   * ReadImageInformation without starting Java, when it holds an up to
+   * date entry for the file */
+  itkSetObjectMacro(Catalog, SCIFIOMetadataCatalog);
+  itkGetModifiableObjectMacro(Catalog, SCIFIOMetadataCatalog);
+
+  /* Filter on file names: suffixes of the only files to read and write,
+   * such as "czi", "ndpi" and "ome.tif", or none (the default) for all
+   * files. Files with other suffixes are turned down without asking Java.
+   * The bridge itself still sets up every format, so this only saves the
+   * probes of other files, not any of its startup time */
+  void SetAllowedFileSuffixes(const std::vector< std::string > & suffixes);
+  const std::vector< std::string > & GetAllowedFileSuffixes() const { return m_AllowedFileSuffixes; }
+
+  /* Whether a file name has one of the allowed suffixes */
+  bool HasAllowedFileSuffix(const std::string & fileName) const;
+
+  /* Cache of the decoded planes read through Java, which are then served
+   * from it by later reads, in this process or another */
+  itkSetObjectMacro(ChunkCache, SCIFIOChunkCache);
+  itkGetModifiableObjectMacro(ChunkCache, SCIFIOChunkCache);
+
   /**---------------Write the data------------------**/
 
   bool CanWriteFile(const char* FileNameToWrite) override;
@@ -119,6 +305,31 @@ public:
   /* Write the data to the disk from the provided memory buffer */
   void Write(const void* buffer) override;
 
+  /* Number of planes that may be packed (converted to a pixel type SCIFIO
+   * supports) ahead of the plane being sent. Only pixel types SCIFIO cannot
+   * store, 64-bit integers, are packed; others are sent from the buffer as
+   * they are. Defaults to 2 */
+  itkSetMacro(WritePipelineDepth, unsigned int);
+  itkGetConstMacro(WritePipelineDepth, unsigned int);
+
+  /* Number of chunks of a plane that may be sent ahead of the bridge's
+   * acknowledgements, for bridges whose acknowledgements count the bytes
+   * received. 1 waits for each chunk to be acknowledged before sending the
+   * next. Defaults to 16 */
+  itkSetClampMacro(WriteWindowSize, unsigned int, 1, 256);
+  itkGetConstMacro(WriteWindowSize, unsigned int);
+
+  /* Number of resolutions written, the full one included, for formats that
+   * store sub-resolutions, such as OME-TIFF. Each sub-resolution is
+   * downsampled from the one above it, plane by plane as planes are sent,
+   * by averaging blocks of DownsampleFactor x DownsampleFactor pixels.
+   * Write throws if the bridge does not accept that many.
+   * Defaults to 1, which writes the full resolution only */
+  itkSetClampMacro(NumberOfResolutions, unsigned int, 1, 32);
+  itkGetConstMacro(NumberOfResolutions, unsigned int);
+  itkSetClampMacro(DownsampleFactor, unsigned int, 2, 64);
+  itkGetConstMacro(DownsampleFactor, unsigned int);
+
 protected:
   SCIFIOImageIO();
   ~SCIFIOImageIO() override;
@@ -126,10 +337,31 @@ protected:
   SizeType GetHeaderSize() const override { return 0; }
 
 private:
+  friend class SCIFIOPlaneStream;
+
   void CreateJavaProcess();
   void DestroyJavaProcess();
-  std::string FindDimensionOrder(const ImageIORegion & region );
-  std::string WaitForNewLines(int pipedatalength);
+  void SendSeries();
+  void ReceiveData(void* buffer, size_t byteCount, bool moreExpected = false);
+  void UpdateImageInformationFromMetaData();
+  ImageIORegion FindDimensionOrder(const ImageIORegion & region );
+  void SendReadCommand(const ImageIORegion & xyztcRegion);
+  void ReadSelection(void* buffer, const ImageIORegion & selectedRegion);
+  bool HasSelection() const;
+  void ReadProjection(void* buffer, const ImageIORegion & projectedRegion);
+  SizeValueType GetSourceComponentSize();
+  bool OpenNative(const std::string & fileName);
+  bool OpenJNI(const std::string & fileName);
+  void ReadJavaRegion(void* buffer, const ImageIORegion & region);
+  void ReadCachedRegion(void* buffer, const ImageIORegion & region);
+  std::string BridgeFileName(const std::string & fileName);
+  void RemovePatternFiles();
+  bool ReadsInProcess();
+  void WriteToPipe(const void* data, size_t byteCount);
+  void SendPlane(const char* data, SizeValueType bytesPerPlane);
+  void SendCommand(const std::string & command);
+  std::string WaitForNewLines(int pipedatalength, bool trace = true);
+  void Trace(char kind, const std::string & fields);
   void CheckError(std::string message);
   bool CheckJavaPath(std::string javaHome, std::string &javaCmd);
   std::string RemoveFinalSlash(std::string path) const;
@@ -200,6 +432,35 @@ private:
   char **                      m_Argv;
   itksysProcess_Pipe_Handle    m_Pipe[2];
   itksysProcess *              m_Process;
+  int                          m_Series;
+  bool                         m_SeriesPending;
+  SizeValueType                m_MaximumTransferSize;
+  unsigned int                 m_WritePipelineDepth;
+  unsigned int                 m_WriteWindowSize;
+  unsigned int                 m_NumberOfResolutions;
+  unsigned int                 m_DownsampleFactor;
+  SCIFIOMetadataCatalog::Pointer m_Catalog;
+  SCIFIOChunkCache::Pointer    m_ChunkCache;
+  std::vector< std::string >   m_AllowedFileSuffixes;
+  bool                         m_UseNativeOMETIFF;
+  SCIFIOOMETIFFReader::Pointer m_NativeReader;
+  std::string                  m_NativeRejectedKey;
+  BackendType                  m_Backend;
+  SCIFIOJNIReader::Pointer     m_JNIReader;
+  IndexListType                m_Selections[3];
+  struct PatternFile
+  {
+    std::string Name;
+    bool        OnDisk = false;
+  };
+  std::map< std::string, PatternFile > m_PatternFiles;
+  ProjectionType               m_Projection;
+  unsigned int                 m_ProjectionAxis;
+  std::string                  m_ReadAhead;
+  std::string                  m_TraceFileName;
+  std::ofstream                m_Trace;
+  std::string                  m_OpenTraceFileName;
+  std::chrono::steady_clock::time_point m_TraceStart;
 };
 } // end namespace itk
 
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSCIFIOJNIReader_h
+#define itkSCIFIOJNIReader_h
+
+#include "SCIFIOExport.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImageIORegion.h"
+#include "itkMetaDataDictionary.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class SCIFIOJNIReader
+ *
+ * \brief Reads files with Bio-Formats in a JVM embedded through JNI.
+ *
+ * The JVM is loaded from the libjvm of the given Java home, started with
+ * the given options on first use, and shared by every reader of the
+ * process: JNI allows only one, and it cannot be restarted once destroyed.
+ * Each call attaches the calling thread to it for its duration.
+ *
+ * ReadRegion() wraps the caller's buffer in direct ByteBuffers, so that
+ * pixels decoded by Bio-Formats are copied into place by Java, without
+ * going through pipes. Pixels are returned in the byte order of the file,
+ * as the bridge returns them, with components interleaved.
+ *
+ * Only available when SCIFIO is built with SCIFIO_USE_JNI; otherwise every
+ * method but IsAvailable() throws.
+ *
+ * \ingroup SCIFIO
+ */
+class SCIFIO_EXPORT SCIFIOJNIReader : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SCIFIOJNIReader);
+
+  using Self = SCIFIOJNIReader;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory **/
+  itkNewMacro(Self);
+
+  /** RTTI (and related methods) **/
+  itkTypeMacro(SCIFIOJNIReader, Object);
+
+  /** Whether SCIFIO was built with JNI support. */
+  static bool IsAvailable();
+
+  /** Java home to load libjvm from. When empty, libjvm must be on the
+   * library path. */
+  itkSetStringMacro(JavaHome);
+  itkGetStringMacro(JavaHome);
+
+  /** Options the JVM is started with, such as -Djava.class.path=... and
+   * -Xmx256m. Ignored once the JVM of the process is running. */
+  void SetJavaOptions(const std::vector< std::string > & options) { m_JavaOptions = options; }
+  const std::vector< std::string > & GetJavaOptions() const { return m_JavaOptions; }
+
+  /** Whether Bio-Formats can read a file. */
+  bool CanRead(const std::string & fileName);
+
+  /** Open a series of a file, switching series without reopening when the
+   * file is already open. */
+  void Open(const std::string & fileName, int series);
+
+  /** Close the open file. */
+  void Close();
+
+  /** Whether a file is open. */
+  bool IsOpen() const { return !m_FileName.empty(); }
+
+  /** File and series that are open. */
+  itkGetStringMacro(FileName);
+  itkGetConstMacro(Series, int);
+
+  /** Number of series of the open file. */
+  int GetSeriesCount() const;
+
+  /** Core metadata of the open series, keyed and formatted as in the
+   * bridge's info reply. */
+  void GetSeriesMetadata(MetaDataDictionary & dict) const;
+
+  /** Read a 5-D region of the open series, in XYZTC order. */
+  void ReadRegion(void * buffer, const ImageIORegion & region) const;
+
+  /** Largest number of bytes Bio-Formats decodes into a single Java array.
+   * Larger planes are read in strips of rows. Defaults to just under 2 GiB,
+   * the most a Java array can hold. */
+  itkSetMacro(MaximumTransferSize, SizeValueType);
+  itkGetConstMacro(MaximumTransferSize, SizeValueType);
+
+protected:
+  SCIFIOJNIReader();
+  ~SCIFIOJNIReader() override;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  std::string                m_JavaHome;
+  std::vector< std::string > m_JavaOptions;
+  std::string                m_FileName;
+  int                        m_Series{ -1 };
+  SizeValueType              m_MaximumTransferSize;
+
+  // Global references to the loci.formats.ImageReader and the OME-XML
+  // metadata it fills, as jobjects; jni.h is kept out of this header.
+  void * m_Reader{ nullptr };
+  void * m_Metadata{ nullptr };
+};
+} // end namespace itk
+
+#endif // itkSCIFIOJNIReader_h
@@ -0,0 +1,159 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSCIFIOMetadataCatalog_h
+#define itkSCIFIOMetadataCatalog_h
+
+#include "SCIFIOExport.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMetaDataDictionary.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class SCIFIOMetadataCatalog
+ *
+ * \brief Persistent catalog of the core metadata of SCIFIO-readable files.
+ *
+ * The catalog maps the full path of each file to the core metadata (sizes,
+ * pixel type, spacing, byte order, ...) of every series it contains, as
+ * reported by the SCIFIO ITK bridge. It is built by crawling a directory
+ * tree with IndexDirectory(), which probes the files in parallel with one
+ * SCIFIOImageIO (and hence one Java process) per worker.
+ *
+ * The catalog can be saved to and loaded from a compact text file. Each
+ * entry records the modification time and length of the file it describes,
+ * so that re-indexing a directory only probes the files that are new or
+ * have changed since the catalog was written, and stale entries are never
+ * served.
+ *
+ * A SCIFIOImageIO given a catalog with SCIFIOImageIO::SetCatalog() answers
+ * CanReadFile(), GetSeriesCount() and ReadImageInformation() for cataloged
+ * files without starting Java.
+ *
+ * \ingroup SCIFIO
+ */
+class SCIFIO_EXPORT SCIFIOMetadataCatalog : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SCIFIOMetadataCatalog);
+
+  using Self = SCIFIOMetadataCatalog;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory **/
+  itkNewMacro(Self);
+
+  /** RTTI (and related methods) **/
+  itkTypeMacro(SCIFIOMetadataCatalog, Object);
+
+  /** Core metadata of one series, keyed as in the bridge's info reply. */
+  using SeriesMetadataType = std::map< std::string, std::string >;
+
+  /** Everything the catalog knows about one file. A file that SCIFIO
+   * cannot read is recorded with no series, so it is not probed again.
+   * Files whose probe failed with an exception, which may be transient,
+   * are not recorded, so that the next IndexDirectory() probes them. The
+   * modification time is kept to the finest resolution the platform
+   * keeps, as by SCIFIOChunkCache::GetModifiedTime(). */
+  struct EntryType
+  {
+    std::string                       FileName;
+    std::string                       ModifiedTime;
+    std::uint64_t                     FileLength{ 0 };
+    std::vector< SeriesMetadataType > Series;
+  };
+
+  using EntryMapType = std::map< std::string, EntryType >;
+
+  /** Number of parallel bridge workers used by IndexDirectory().
+   * Defaults to the number of hardware threads, capped at 4. */
+  itkSetMacro(NumberOfWorkers, unsigned int);
+  itkGetConstMacro(NumberOfWorkers, unsigned int);
+
+  /** Whether IndexDirectory() descends into subdirectories. On by default. */
+  itkSetMacro(Recursive, bool);
+  itkGetConstMacro(Recursive, bool);
+  itkBooleanMacro(Recursive);
+
+  /** Number of files that the last IndexDirectory() call had to probe
+   * through the bridge, i.e. that were not already up to date. */
+  itkGetConstMacro(NumberOfProbedFiles, SizeValueType);
+
+  /** Replace the contents of the catalog with those of a catalog file. */
+  void Load(const std::string & fileName);
+
+  /** Write the catalog to a file. */
+  void Save(const std::string & fileName) const;
+
+  /** Crawl a directory and add or refresh the entry of every file in it.
+   * Entries that are up to date are kept as they are; entries of files
+   * under the directory that no longer exist are removed. Files the bridge
+   * fails on are skipped with a warning. */
+  void IndexDirectory(const std::string & directory);
+
+  /** Copy the entry of a file. Returns false, leaving the entry untouched,
+   * if the file is not cataloged or has changed on disk since it was
+   * cataloged. The copy is made under the catalog's lock, so it is safe
+   * while other threads index or update the catalog. */
+  bool GetEntry(const std::string & fileName, EntryType & entry) const;
+
+  /** Copy the metadata of one series of a file into a dictionary. Returns
+   * false, leaving the dictionary untouched, if GetEntry() would fail or
+   * the series does not exist. */
+  bool GetSeriesMetadata(const std::string & fileName, int series, MetaDataDictionary & dict) const;
+
+  /** Add or replace the entry of a file. */
+  void SetEntry(const EntryType & entry);
+
+  /** A copy of all entries, keyed by full path; useful for querying the
+   * catalog. */
+  EntryMapType GetEntries() const;
+
+  /** Remove all entries. */
+  void Clear();
+
+  /** The metadata keys that are stored for each series. */
+  static const std::vector< std::string > & GetCoreMetadataKeys();
+
+protected:
+  SCIFIOMetadataCatalog();
+  ~SCIFIOMetadataCatalog() override = default;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  bool IsUpToDate(const EntryType & entry) const;
+  void ListFiles(const std::string & directory, std::vector< std::string > & files) const;
+
+  EntryMapType       m_Entries;
+  mutable std::mutex m_Mutex;
+  unsigned int       m_NumberOfWorkers;
+  bool               m_Recursive{ true };
+  SizeValueType      m_NumberOfProbedFiles{ 0 };
+};
+} // end namespace itk
+
+#endif // itkSCIFIOMetadataCatalog_h
@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSCIFIOOMETIFFReader_h
+#define itkSCIFIOOMETIFFReader_h
+
+#include "SCIFIOExport.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImageIORegion.h"
+#include "itkMetaDataDictionary.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class SCIFIOOMETIFFReader
+ *
+ * \brief Reads single-file OME-TIFF datasets natively, without Java.
+ *
+ * Open() parses the OME-XML in the ImageDescription of the first IFD for
+ * the sizes, pixel type, dimension order and the mapping of the planes of
+ * a series to IFDs. It only accepts datasets it can decode the same way
+ * SCIFIO would: all planes in the file itself, one sample format
+ * throughout, RGB samples interleaved, every IFD holding planes of the
+ * size and layout the OME-XML gives, and codecs known to ITK's TIFF
+ * library. Anything else is left to the bridge.
+ *
+ * ReadRegion() reads the strips or tiles covering an XYZTC region, decoding
+ * bands of rows of every plane in parallel, with one TIFF handle per
+ * thread. Handles stay open between calls, and seek to the IFDs of the
+ * planes by the offsets Open() recorded. Pixels are returned in native byte order, laid out as
+ * SCIFIOImageIO::ReadXYZTCRegion lays them out.
+ *
+ * SCIFIOImageIO uses this class for files with an OME-TIFF extension,
+ * unless SetUseNativeOMETIFF(false) is called.
+ *
+ * \ingroup SCIFIO
+ */
+class SCIFIO_EXPORT SCIFIOOMETIFFReader : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SCIFIOOMETIFFReader);
+
+  using Self = SCIFIOOMETIFFReader;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory **/
+  itkNewMacro(Self);
+
+  /** RTTI (and related methods) **/
+  itkTypeMacro(SCIFIOOMETIFFReader, Object);
+
+  /** Whether a file name ends in one of the OME-TIFF extensions. */
+  static bool HasOMETIFFExtension(const std::string & fileName);
+
+  /** Open a series of a file. Returns false, leaving the reader closed, if
+   * the file is not an OME-TIFF dataset that can be read natively. */
+  bool Open(const std::string & fileName, int series);
+
+  /** Forget the open file. */
+  void Close();
+
+  /** Whether a series of a file is open. */
+  bool IsOpen() const { return !m_PlaneIFDs.empty(); }
+
+  /** File and series that are open. */
+  itkGetStringMacro(FileName);
+  itkGetConstMacro(Series, int);
+
+  /** Number of series (OME Images) of the open file. */
+  itkGetConstMacro(SeriesCount, int);
+
+  /** Core metadata of the open series, keyed and formatted as in the
+   * bridge's info reply. */
+  void GetSeriesMetadata(MetaDataDictionary & dict) const;
+
+  /** Read a 5-D region of the open series, in XYZTC order. */
+  void ReadRegion(void * buffer, const ImageIORegion & region) const;
+
+  /** Number of threads ReadRegion decodes with. Defaults to the number of
+   * hardware threads. */
+  itkSetMacro(NumberOfWorkUnits, unsigned int);
+  itkGetConstMacro(NumberOfWorkUnits, unsigned int);
+
+protected:
+  SCIFIOOMETIFFReader();
+  ~SCIFIOOMETIFFReader() override;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  struct TIFFHandle;
+
+  /** A handle on the open file, from those kept by earlier reads if any. */
+  std::unique_ptr< TIFFHandle > AcquireHandle() const;
+  void ReleaseHandle(std::unique_ptr< TIFFHandle > handle) const;
+
+  std::string                  m_FileName;
+  int                          m_Series{ -1 };
+  int                          m_SeriesCount{ 0 };
+  SizeValueType                m_Sizes[5];
+  double                       m_PhysicalSizes[5];
+  std::string                  m_DimensionOrder;
+  int                          m_PixelType{ 1 };
+  unsigned int                 m_BytesPerSample{ 1 };
+  unsigned int                 m_SamplesPerPixel{ 1 };
+  std::vector< unsigned int >  m_PlaneIFDs;
+  std::vector< std::uint64_t > m_IFDOffsets;
+  unsigned int                 m_NumberOfWorkUnits;
+
+  mutable std::mutex                                  m_HandlesMutex;
+  mutable std::vector< std::unique_ptr< TIFFHandle > > m_Handles;
+};
+} // end namespace itk
+
+#endif // itkSCIFIOOMETIFFReader_h
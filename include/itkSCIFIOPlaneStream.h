@@ -0,0 +1,161 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSCIFIOPlaneStream_h
+#define itkSCIFIOPlaneStream_h
+
+#include "SCIFIOExport.h"
+#include "itkSCIFIOImageIO.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace itk
+{
+/** \class SCIFIOPlaneStream
+ *
+ * \brief Iterates over the XY planes of a SCIFIO dataset in file order,
+ * in constant memory.
+ *
+ * Open() reads the image information of a series, and starts a thread
+ * that reads planes into a ring of NumberOfBuffers plane buffers, keeping
+ * a read command queued with Java for each free buffer. Next() then moves
+ * to the following plane, only waiting if it has not arrived yet:
+ *
+ * \code
+ * stream->SetFileName( fileName );
+ * stream->Open();
+ * while( stream->Next() )
+ *   {
+ *   process( stream->GetPlane(), stream->GetZ(), stream->GetC(), stream->GetT() );
+ *   }
+ * \endcode
+ *
+ * Planes are visited in the order of the file's DimensionOrder, and hold
+ * GetPlaneBufferSize() bytes laid out as ReadXYZTCRegion() lays them out,
+ * in the byte order of the file. The plane returned by GetPlane() stays
+ * valid until the next call to Next() or Close(). However long the
+ * dataset, at most NumberOfBuffers planes are held in memory.
+ *
+ * The stream uses its SCIFIOImageIO exclusively between Open() and
+ * Close(). Every plane of the file is streamed, so Open() throws if the
+ * ImageIO has a selection or a projection set. Whatever the reading thread
+ * throws is rethrown by Next().
+ *
+ * \ingroup SCIFIO
+ */
+class SCIFIO_EXPORT SCIFIOPlaneStream : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_ASSIGN(SCIFIOPlaneStream);
+
+  using Self = SCIFIOPlaneStream;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory **/
+  itkNewMacro(Self);
+
+  /** RTTI (and related methods) **/
+  itkTypeMacro(SCIFIOPlaneStream, Object);
+
+  /** File to stream the planes of. */
+  itkSetStringMacro(FileName);
+  itkGetStringMacro(FileName);
+
+  /** Series to stream. Defaults to 0. */
+  itkSetMacro(Series, int);
+  itkGetConstMacro(Series, int);
+
+  /** Number of plane buffers in the ring, at least 2: one for the plane
+   * being processed, the others being filled meanwhile. Defaults to 3. */
+  itkSetClampMacro(NumberOfBuffers, unsigned int, 2, NumericTraits< unsigned int >::max());
+  itkGetConstMacro(NumberOfBuffers, unsigned int);
+
+  /** ImageIO used to talk to Java. One is created if none is set, so that
+   * a configured ImageIO, e.g. with a catalog, can be reused. */
+  itkSetObjectMacro(ImageIO, SCIFIOImageIO);
+  itkGetModifiableObjectMacro(ImageIO, SCIFIOImageIO);
+
+  /** Read the image information and start streaming from the first plane. */
+  void Open();
+
+  /** Stop streaming, and wait for the reading thread to finish. Called by
+   * Open() and the destructor. */
+  void Close();
+
+  /** Move to the next plane. Returns false when all planes were visited.
+   * Rethrows the exception that stopped the reading thread, if any. */
+  bool Next();
+
+  /** Pixels of the current plane. */
+  const void * GetPlane() const;
+
+  /** Number of bytes of each plane. */
+  itkGetConstMacro(PlaneBufferSize, SizeValueType);
+
+  /** Number of planes of the series. */
+  itkGetConstMacro(NumberOfPlanes, SizeValueType);
+
+  /** Position of the current plane in the file, and along each axis. */
+  itkGetConstMacro(PlaneNumber, SizeValueType);
+  itkGetConstMacro(Z, SizeValueType);
+  itkGetConstMacro(C, SizeValueType);
+  itkGetConstMacro(T, SizeValueType);
+
+protected:
+  SCIFIOPlaneStream();
+  ~SCIFIOPlaneStream() override;
+
+  void PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  ImageIORegion GetPlaneRegion(SizeValueType plane) const;
+  void ReadPlanes();
+
+  std::string                m_FileName;
+  int                        m_Series{ 0 };
+  unsigned int               m_NumberOfBuffers{ 3 };
+  SCIFIOImageIO::Pointer     m_ImageIO;
+
+  ImageIORegion              m_LargestRegion;
+  unsigned int               m_PlaneAxes[3];
+  SizeValueType              m_PlaneBufferSize{ 0 };
+  SizeValueType              m_NumberOfPlanes{ 0 };
+  SizeValueType              m_PlaneNumber{ 0 };
+  SizeValueType              m_Z{ 0 };
+  SizeValueType              m_C{ 0 };
+  SizeValueType              m_T{ 0 };
+
+  std::vector< std::vector< char > > m_Buffers;
+  std::thread                m_Thread;
+  std::mutex                 m_Mutex;
+  std::condition_variable    m_Condition;
+  SizeValueType              m_PlanesRead{ 0 };
+  SizeValueType              m_PlanesReleased{ 0 };
+  bool                       m_Started{ false };
+  bool                       m_Stop{ false };
+  std::exception_ptr         m_Exception;
+};
+} // end namespace itk
+
+#endif // itkSCIFIOPlaneStream_h
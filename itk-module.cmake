@@ -6,8 +6,12 @@ itk_module(SCIFIO
   ENABLE_SHARED
   DEPENDS
     ITKIOImageBase
+  PRIVATE_DEPENDS
+    ITKTIFF
+    ITKExpat
   TEST_DEPENDS
     ITKTestKernel
+    ITKTIFF
   EXCLUDE_FROM_DEFAULT
   FACTORY_NAMES
     ImageIO::SCIFIO
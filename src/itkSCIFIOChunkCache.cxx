@@ -0,0 +1,405 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSCIFIOChunkCache.h"
+#include "itkSCIFIOImageIO.h"
+
+#include "itksys/Directory.hxx"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const char * const ChunkMagic = "SCIFIOChunk";
+  const int ChunkVersion = 1;
+  const char * const ChunkExtension = ".chunk";
+
+  // Pixels start on a page boundary, after the header line and padding.
+  const itk::SizeValueType ChunkAlignment = 4096;
+
+  // FNV-1a, to name chunk files after their keys.
+  unsigned long long hashKey( const std::string & key )
+  {
+    unsigned long long hash = 14695981039346656037ULL;
+    for( unsigned char c : key )
+      {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+      }
+    return hash;
+  }
+
+  long getProcessId()
+  {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return getpid();
+#endif
+  }
+
+  // Keys hold tabs but no newlines, which would end the header line.
+  std::string headerLine( const std::string & key, itk::SizeValueType size )
+  {
+    std::ostringstream header;
+    header << ChunkMagic << "\t" << ChunkVersion << "\t" << size << "\t" << key << "\n";
+    return header.str();
+  }
+
+  itk::SizeValueType dataOffset( const std::string & header )
+  {
+    return ( header.size() + ChunkAlignment - 1 ) / ChunkAlignment * ChunkAlignment;
+  }
+
+  bool hasChunkExtension( const std::string & fileName )
+  {
+    const size_t length = std::char_traits< char >::length( ChunkExtension );
+    return fileName.size() > length && fileName.compare( fileName.size() - length, length, ChunkExtension ) == 0;
+  }
+}
+
+namespace itk
+{
+SCIFIOChunkCache::MappedChunk::~MappedChunk()
+{
+#ifdef _WIN32
+  if( m_Mapping )
+    {
+    UnmapViewOfFile( m_Mapping );
+    }
+  if( m_MappingHandle )
+    {
+    CloseHandle( m_MappingHandle );
+    }
+#else
+  if( m_Mapping )
+    {
+    munmap( m_Mapping, m_MappingSize );
+    }
+#endif
+}
+
+std::string
+SCIFIOChunkCache::MakeKey(const std::string & fileName, int series, SizeValueType plane)
+{
+  // The files a pattern stands for may change without the name telling.
+  if( SCIFIOImageIO::IsFilePattern( fileName ) || !itksys::SystemTools::FileExists( fileName, true ) )
+    {
+    return "";
+    }
+  std::ostringstream key;
+  key << itksys::SystemTools::CollapseFullPath( fileName ) << "\t"
+      << GetFileLength( fileName ) << "\t"
+      << GetModifiedTime( fileName ) << "\t"
+      << series << "\t" << plane;
+  return key.str();
+}
+
+std::string
+SCIFIOChunkCache::GetModifiedTime(const std::string & fileName)
+{
+  std::ostringstream time;
+#ifdef _WIN32
+  WIN32_FILE_ATTRIBUTE_DATA attributes;
+  if( GetFileAttributesExA( fileName.c_str(), GetFileExInfoStandard, &attributes ) )
+    {
+    time << attributes.ftLastWriteTime.dwHighDateTime << "." << attributes.ftLastWriteTime.dwLowDateTime;
+    }
+#else
+  struct stat status;
+  if( stat( fileName.c_str(), &status ) == 0 )
+    {
+#if defined(__APPLE__)
+    time << status.st_mtimespec.tv_sec << "." << status.st_mtimespec.tv_nsec;
+#else
+    time << status.st_mtim.tv_sec << "." << status.st_mtim.tv_nsec;
+#endif
+    }
+#endif
+  return time.str();
+}
+
+std::uint64_t
+SCIFIOChunkCache::GetFileLength(const std::string & fileName)
+{
+#ifdef _WIN32
+  WIN32_FILE_ATTRIBUTE_DATA attributes;
+  if( GetFileAttributesExA( fileName.c_str(), GetFileExInfoStandard, &attributes ) )
+    {
+    return ( static_cast< std::uint64_t >( attributes.nFileSizeHigh ) << 32 ) | attributes.nFileSizeLow;
+    }
+#else
+  struct stat status;
+  if( stat( fileName.c_str(), &status ) == 0 )
+    {
+    return static_cast< std::uint64_t >( status.st_size );
+    }
+#endif
+  return 0;
+}
+
+std::string
+SCIFIOChunkCache::ChunkFileName(const std::string & key) const
+{
+  std::ostringstream name;
+  name << m_Directory << "/" << std::hex;
+  name.width( 16 );
+  name.fill( '0' );
+  name << hashKey( key ) << ChunkExtension;
+  return name.str();
+}
+
+SCIFIOChunkCache::MappedChunkPointer
+SCIFIOChunkCache::Find(const std::string & key)
+{
+  const std::string fileName = this->ChunkFileName( key );
+
+  // The header names the key, in case of a hash collision, and the size,
+  // which the file must match in full.
+  MappedChunkPointer chunk;
+  std::string header;
+  {
+  std::ifstream in( fileName.c_str(), std::ios::binary );
+  std::getline( in, header );
+  }
+  std::istringstream fields( header );
+  std::string magic;
+  int version = 0;
+  SizeValueType size = 0;
+  std::string chunkKey;
+  if( std::getline( fields, magic, '\t' ) && magic == ChunkMagic && fields >> version && version == ChunkVersion
+      && fields >> size && fields.get() == '\t' && std::getline( fields, chunkKey ) && chunkKey == key )
+    {
+    const SizeValueType offset = dataOffset( header + "\n" );
+    chunk.reset( new MappedChunk );
+#ifdef _WIN32
+    HANDLE file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( file != INVALID_HANDLE_VALUE )
+      {
+      LARGE_INTEGER fileSize;
+      if( GetFileSizeEx( file, &fileSize ) && SizeValueType( fileSize.QuadPart ) == offset + size )
+        {
+        chunk->m_MappingHandle = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+        if( chunk->m_MappingHandle )
+          {
+          chunk->m_Mapping = MapViewOfFile( chunk->m_MappingHandle, FILE_MAP_READ, 0, 0, 0 );
+          }
+        }
+      CloseHandle( file );
+      }
+#else
+    const int file = open( fileName.c_str(), O_RDONLY );
+    if( file >= 0 )
+      {
+      struct stat fileStat;
+      if( fstat( file, &fileStat ) == 0 && SizeValueType( fileStat.st_size ) == offset + size )
+        {
+        void * mapping = mmap( nullptr, offset + size, PROT_READ, MAP_SHARED, file, 0 );
+        if( mapping != MAP_FAILED )
+          {
+          chunk->m_Mapping = mapping;
+          chunk->m_MappingSize = offset + size;
+          }
+        }
+      close( file );
+      }
+#endif
+    if( chunk->m_Mapping )
+      {
+      chunk->m_Data = static_cast< const char * >( chunk->m_Mapping ) + offset;
+      chunk->m_Size = size;
+      }
+    else
+      {
+      chunk.reset();
+      }
+    }
+
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  if( !chunk )
+    {
+    ++m_NumberOfMisses;
+    return chunk;
+    }
+  ++m_NumberOfHits;
+  itksys::SystemTools::Touch( fileName, false );
+  return chunk;
+}
+
+bool
+SCIFIOChunkCache::Insert(const std::string & key, const void * data, SizeValueType size)
+{
+  if( m_Directory.empty() || key.empty() || key.find( '\n' ) != std::string::npos )
+    {
+    return false;
+    }
+  if( !itksys::SystemTools::FileIsDirectory( m_Directory ) && !itksys::SystemTools::MakeDirectory( m_Directory ) )
+    {
+    itkDebugMacro(<< "Cannot create cache directory " << m_Directory);
+    return false;
+    }
+
+  const std::string fileName = this->ChunkFileName( key );
+  SizeValueType insert;
+  {
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  insert = m_NumberOfInserts++;
+  }
+  std::ostringstream tmpFileName;
+  tmpFileName << fileName << "." << getProcessId() << "-" << std::hash< std::thread::id >()( std::this_thread::get_id() )
+              << "-" << insert << ".tmp";
+
+  // Readers only ever see complete chunks: a chunk is written in full to a
+  // temporary file, which is then renamed over any previous one.
+  const std::string header = headerLine( key, size );
+  const SizeValueType offset = dataOffset( header );
+  {
+  std::ofstream out( tmpFileName.str().c_str(), std::ios::binary );
+  out.write( header.data(), header.size() );
+  const std::vector< char > padding( offset - header.size(), '\0' );
+  out.write( padding.data(), padding.size() );
+  out.write( static_cast< const char * >( data ), size );
+  out.close();
+  if( !out )
+    {
+    itkDebugMacro(<< "Cannot write chunk file " << tmpFileName.str());
+    itksys::SystemTools::RemoveFile( tmpFileName.str() );
+    return false;
+    }
+  }
+  if( !itksys::SystemTools::RenameFile( tmpFileName.str(), fileName ) )
+    {
+    itkDebugMacro(<< "Cannot rename " << tmpFileName.str() << " to " << fileName);
+    itksys::SystemTools::RemoveFile( tmpFileName.str() );
+    return false;
+    }
+
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  if( m_KnownSize >= 0 )
+    {
+    m_KnownSize += offset + size;
+    }
+  if( m_KnownSize < 0 || SizeValueType( m_KnownSize ) > m_MaximumSize )
+    {
+    this->Evict();
+    }
+  return true;
+}
+
+void
+SCIFIOChunkCache::Evict()
+{
+  // Other processes may have added or removed chunks, so the directory is
+  // listed again, and the least recently used chunks removed until they
+  // take up no more than 90% of the maximum size, to leave room to grow.
+  struct ChunkFile
+  {
+    std::string   FileName;
+    SizeValueType Size;
+  };
+  std::vector< ChunkFile > chunks;
+  SizeValueType total = 0;
+  itksys::Directory dir;
+  if( dir.Load( m_Directory ) )
+    {
+    for( unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i )
+      {
+      const std::string name = dir.GetFile( i );
+      if( hasChunkExtension( name ) )
+        {
+        const std::string path = m_Directory + "/" + name;
+        chunks.push_back( { path, static_cast< SizeValueType >( itksys::SystemTools::FileLength( path ) ) } );
+        total += chunks.back().Size;
+        }
+      }
+    }
+
+  if( total > m_MaximumSize )
+    {
+    const SizeValueType target = m_MaximumSize / 10 * 9;
+    std::sort( chunks.begin(), chunks.end(), []( const ChunkFile & a, const ChunkFile & b )
+      {
+      int result = 0;
+      itksys::SystemTools::FileTimeCompare( a.FileName, b.FileName, &result );
+      return result < 0;
+      } );
+    for( const ChunkFile & chunk : chunks )
+      {
+      if( total <= target )
+        {
+        break;
+        }
+      // A chunk mapped elsewhere may not be removable on Windows; it stays.
+      if( itksys::SystemTools::RemoveFile( chunk.FileName ) )
+        {
+        itkDebugMacro(<< "Evicted " << chunk.FileName);
+        total -= chunk.Size;
+        }
+      }
+    }
+  m_KnownSize = total;
+}
+
+void
+SCIFIOChunkCache::Clear()
+{
+  itksys::Directory dir;
+  if( !dir.Load( m_Directory ) )
+    {
+    return;
+    }
+  for( unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i )
+    {
+    const std::string name = dir.GetFile( i );
+    if( hasChunkExtension( name ) )
+      {
+      itksys::SystemTools::RemoveFile( m_Directory + "/" + name );
+      }
+    }
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  m_KnownSize = 0;
+}
+
+void
+SCIFIOChunkCache::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "Directory: " << m_Directory << std::endl;
+  os << indent << "MaximumSize: " << m_MaximumSize << std::endl;
+  os << indent << "NumberOfHits: " << m_NumberOfHits << std::endl;
+  os << indent << "NumberOfMisses: " << m_NumberOfMisses << std::endl;
+}
+} // end namespace itk
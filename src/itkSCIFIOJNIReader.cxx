@@ -0,0 +1,619 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSCIFIOJNIReader.h"
+#include "itkMetaDataObject.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#ifdef SCIFIO_USE_JNI
+#include "itksys/SystemTools.hxx"
+
+#include <jni.h>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+#endif
+
+namespace
+{
+#ifdef SCIFIO_USE_JNI
+  template< typename T >
+  std::string toString( const T & value )
+  {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+  }
+
+  // Bytes per sample of the Bio-Formats pixel types, INT8 to DOUBLE.
+  unsigned int bytesPerSample( int pixelType )
+  {
+    const unsigned int sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+    return pixelType >= 0 && pixelType < 8 ? sizes[pixelType] : 1;
+  }
+
+  using CreateJavaVMFunction = jint ( JNICALL * )( JavaVM **, void **, void * );
+  using GetCreatedJavaVMsFunction = jint ( JNICALL * )( JavaVM **, jsize, jsize * );
+
+  std::mutex javaVMMutex;
+  JavaVM *   javaVM = nullptr;
+
+  void * loadLibrary( const std::string & path )
+  {
+#ifdef _WIN32
+    return reinterpret_cast< void * >( LoadLibraryA( path.c_str() ) );
+#else
+    return dlopen( path.c_str(), RTLD_NOW | RTLD_GLOBAL );
+#endif
+  }
+
+  void * findSymbol( void * library, const char * name )
+  {
+#ifdef _WIN32
+    return reinterpret_cast< void * >( GetProcAddress( static_cast< HMODULE >( library ), name ) );
+#else
+    return dlsym( library, name );
+#endif
+  }
+
+  // Looks for libjvm where JDKs and JREs of Java 6 onwards keep it, then on
+  // the library path.
+  void * loadJavaVMLibrary( const std::string & javaHome )
+  {
+#if defined(_WIN32)
+    const char * candidates[] = { "bin/server/jvm.dll", "jre/bin/server/jvm.dll",
+                                  "bin/client/jvm.dll", "jre/bin/client/jvm.dll" };
+    const char * fallback = "jvm.dll";
+#elif defined(__APPLE__)
+    const char * candidates[] = { "lib/server/libjvm.dylib", "jre/lib/server/libjvm.dylib" };
+    const char * fallback = "libjvm.dylib";
+#else
+    const char * candidates[] = { "lib/server/libjvm.so", "jre/lib/amd64/server/libjvm.so",
+                                  "lib/amd64/server/libjvm.so", "jre/lib/i386/client/libjvm.so",
+                                  "lib/i386/client/libjvm.so" };
+    const char * fallback = "libjvm.so";
+#endif
+    if( !javaHome.empty() )
+      {
+      for( const char * candidate : candidates )
+        {
+        const std::string path = javaHome + "/" + candidate;
+        if( itksys::SystemTools::FileExists( path, true ) )
+          {
+          void * library = loadLibrary( path );
+          if( library != nullptr )
+            {
+            return library;
+            }
+          }
+        }
+      }
+    return loadLibrary( fallback );
+  }
+
+  JavaVM * getJavaVM( const std::string & javaHome, const std::vector< std::string > & options )
+  {
+    std::lock_guard< std::mutex > lock( javaVMMutex );
+    if( javaVM != nullptr )
+      {
+      return javaVM;
+      }
+
+    void * library = loadJavaVMLibrary( javaHome );
+    if( library == nullptr )
+      {
+      itkGenericExceptionMacro(<< "SCIFIOJNIReader: cannot load libjvm from Java home '" << javaHome << "'");
+      }
+    auto getCreatedJavaVMs = reinterpret_cast< GetCreatedJavaVMsFunction >( findSymbol( library, "JNI_GetCreatedJavaVMs" ) );
+    auto createJavaVM = reinterpret_cast< CreateJavaVMFunction >( findSymbol( library, "JNI_CreateJavaVM" ) );
+    if( getCreatedJavaVMs == nullptr || createJavaVM == nullptr )
+      {
+      itkGenericExceptionMacro(<< "SCIFIOJNIReader: libjvm of Java home '" << javaHome << "' lacks the invocation API");
+      }
+
+    // The application may already run a JVM of its own.
+    jsize count = 0;
+    if( getCreatedJavaVMs( &javaVM, 1, &count ) == JNI_OK && count > 0 )
+      {
+      return javaVM;
+      }
+    javaVM = nullptr;
+
+    std::vector< JavaVMOption > vmOptions( options.size() );
+    for( size_t i = 0; i < options.size(); ++i )
+      {
+      vmOptions[i].optionString = const_cast< char * >( options[i].c_str() );
+      vmOptions[i].extraInfo = nullptr;
+      }
+    JavaVMInitArgs arguments;
+    arguments.version = JNI_VERSION_1_6;
+    arguments.nOptions = static_cast< jint >( vmOptions.size() );
+    arguments.options = vmOptions.empty() ? nullptr : &vmOptions[0];
+    arguments.ignoreUnrecognized = JNI_FALSE;
+
+    JNIEnv * env = nullptr;
+    const jint result = createJavaVM( &javaVM, reinterpret_cast< void ** >( &env ), &arguments );
+    if( result != JNI_OK )
+      {
+      javaVM = nullptr;
+      itkGenericExceptionMacro(<< "SCIFIOJNIReader: JNI_CreateJavaVM failed with error " << result);
+      }
+
+    // Every call attaches its thread for its duration, this one included.
+    javaVM->DetachCurrentThread();
+    return javaVM;
+  }
+
+  // Attaches the calling thread to the JVM, unless it already is, and gives
+  // it a frame of local references, for the lifetime of the object.
+  class AttachedThread
+  {
+  public:
+    explicit AttachedThread( JavaVM * vm ) : m_VM( vm )
+    {
+      if( vm->GetEnv( reinterpret_cast< void ** >( &m_Env ), JNI_VERSION_1_6 ) == JNI_EDETACHED )
+        {
+        if( vm->AttachCurrentThread( reinterpret_cast< void ** >( &m_Env ), nullptr ) != JNI_OK )
+          {
+          itkGenericExceptionMacro(<< "SCIFIOJNIReader: cannot attach the thread to the JVM");
+          }
+        m_Attached = true;
+        }
+      m_Env->PushLocalFrame( 64 );
+    }
+
+    ~AttachedThread()
+    {
+      m_Env->PopLocalFrame( nullptr );
+      if( m_Attached )
+        {
+        m_VM->DetachCurrentThread();
+        }
+    }
+
+    JNIEnv * operator->() const { return m_Env; }
+    operator JNIEnv *() const { return m_Env; }
+
+  private:
+    JavaVM * m_VM;
+    JNIEnv * m_Env{ nullptr };
+    bool     m_Attached{ false };
+  };
+
+  // Turns a pending Java exception into an ITK one.
+  void checkJavaException( JNIEnv * env, const char * what )
+  {
+    if( !env->ExceptionCheck() )
+      {
+      return;
+      }
+    jthrowable exception = env->ExceptionOccurred();
+    env->ExceptionClear();
+
+    std::string message = "unknown error";
+    jclass throwableClass = env->FindClass( "java/lang/Throwable" );
+    jmethodID toStringMethod = env->GetMethodID( throwableClass, "toString", "()Ljava/lang/String;" );
+    auto text = static_cast< jstring >( env->CallObjectMethod( exception, toStringMethod ) );
+    if( text != nullptr && !env->ExceptionCheck() )
+      {
+      const char * chars = env->GetStringUTFChars( text, nullptr );
+      message = chars;
+      env->ReleaseStringUTFChars( text, chars );
+      }
+    env->ExceptionClear();
+    itkGenericExceptionMacro(<< "SCIFIOJNIReader: " << what << " failed: " << message);
+  }
+
+  jmethodID getMethod( JNIEnv * env, jobject object, const char * name, const char * signature )
+  {
+    jmethodID method = env->GetMethodID( env->GetObjectClass( object ), name, signature );
+    checkJavaException( env, name );
+    return method;
+  }
+
+  jint callInt( JNIEnv * env, jobject object, const char * name )
+  {
+    const jint value = env->CallIntMethod( object, getMethod( env, object, name, "()I" ) );
+    checkJavaException( env, name );
+    return value;
+  }
+
+  bool callBoolean( JNIEnv * env, jobject object, const char * name )
+  {
+    const bool value = env->CallBooleanMethod( object, getMethod( env, object, name, "()Z" ) ) == JNI_TRUE;
+    checkJavaException( env, name );
+    return value;
+  }
+
+  // Value of a length or time quantity of the OME-XML metadata, or 1 if
+  // the file does not have it.
+  double physicalSize( JNIEnv * env, jobject metadata, const char * getter, const char * signature, int series )
+  {
+    jobject quantity = env->CallObjectMethod( metadata, getMethod( env, metadata, getter, signature ), series );
+    checkJavaException( env, getter );
+    if( quantity == nullptr )
+      {
+      return 1.0;
+      }
+    jobject value = env->CallObjectMethod( quantity, getMethod( env, quantity, "value", "()Ljava/lang/Number;" ) );
+    checkJavaException( env, getter );
+    if( value == nullptr )
+      {
+      return 1.0;
+      }
+    const double size = env->CallDoubleMethod( value, getMethod( env, value, "doubleValue", "()D" ) );
+    checkJavaException( env, getter );
+    return size > 0.0 ? size : 1.0;
+  }
+
+  // Creates the ImageReader, which instantiates every Bio-Formats reader,
+  // once per SCIFIOJNIReader, with OME-XML metadata for the physical sizes.
+  void createReader( JNIEnv * env, void *& reader, void *& metadata )
+  {
+    if( reader != nullptr )
+      {
+      return;
+      }
+    jclass toolsClass = env->FindClass( "loci/formats/MetadataTools" );
+    checkJavaException( env, "loading loci.formats.MetadataTools" );
+    jmethodID createMetadata =
+      env->GetStaticMethodID( toolsClass, "createOMEXMLMetadata", "()Lloci/formats/meta/IMetadata;" );
+    checkJavaException( env, "MetadataTools.createOMEXMLMetadata" );
+    jobject store = env->CallStaticObjectMethod( toolsClass, createMetadata );
+    checkJavaException( env, "MetadataTools.createOMEXMLMetadata" );
+
+    jclass readerClass = env->FindClass( "loci/formats/ImageReader" );
+    checkJavaException( env, "loading loci.formats.ImageReader" );
+    jmethodID constructor = env->GetMethodID( readerClass, "<init>", "()V" );
+    checkJavaException( env, "ImageReader()" );
+    jobject imageReader = env->NewObject( readerClass, constructor );
+    checkJavaException( env, "ImageReader()" );
+    env->CallVoidMethod( imageReader,
+                         getMethod( env, imageReader, "setMetadataStore", "(Lloci/formats/meta/MetadataStore;)V" ),
+                         store );
+    checkJavaException( env, "ImageReader.setMetadataStore" );
+
+    reader = env->NewGlobalRef( imageReader );
+    metadata = env->NewGlobalRef( store );
+  }
+#else
+  [[noreturn]] void unavailable()
+  {
+    itkGenericExceptionMacro(<< "SCIFIOJNIReader: SCIFIO was built without JNI support; "
+                             "configure it with SCIFIO_USE_JNI=ON");
+  }
+#endif
+}
+
+namespace itk
+{
+
+SCIFIOJNIReader::SCIFIOJNIReader() :
+  m_MaximumTransferSize( ( SizeValueType( 1 ) << 31 ) - 1024 )
+{
+}
+
+bool
+SCIFIOJNIReader::IsAvailable()
+{
+#ifdef SCIFIO_USE_JNI
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef SCIFIO_USE_JNI
+
+SCIFIOJNIReader::~SCIFIOJNIReader()
+{
+  if( m_Reader == nullptr )
+    {
+    return;
+    }
+  try
+    {
+    AttachedThread env( getJavaVM( m_JavaHome, m_JavaOptions ) );
+    auto reader = static_cast< jobject >( m_Reader );
+    env->CallVoidMethod( reader, getMethod( env, reader, "close", "()V" ) );
+    env->ExceptionClear();
+    env->DeleteGlobalRef( reader );
+    env->DeleteGlobalRef( static_cast< jobject >( m_Metadata ) );
+    }
+  catch( ExceptionObject & )
+    {
+    // The JVM is gone; there is nothing left to release.
+    }
+}
+
+bool
+SCIFIOJNIReader::CanRead(const std::string & fileName)
+{
+  AttachedThread env( getJavaVM( m_JavaHome, m_JavaOptions ) );
+  createReader( env, m_Reader, m_Metadata );
+  auto reader = static_cast< jobject >( m_Reader );
+  const bool canRead = env->CallBooleanMethod( reader,
+                                               getMethod( env, reader, "isThisType", "(Ljava/lang/String;)Z" ),
+                                               env->NewStringUTF( fileName.c_str() ) ) == JNI_TRUE;
+  if( env->ExceptionCheck() )
+    {
+    // Files Bio-Formats fails to probe are files it cannot read.
+    env->ExceptionClear();
+    return false;
+    }
+  return canRead;
+}
+
+void
+SCIFIOJNIReader::Open(const std::string & fileName, int series)
+{
+  AttachedThread env( getJavaVM( m_JavaHome, m_JavaOptions ) );
+  createReader( env, m_Reader, m_Metadata );
+  auto reader = static_cast< jobject >( m_Reader );
+
+  if( fileName != m_FileName )
+    {
+    itkDebugMacro(<< "Opening " << fileName);
+    m_FileName.clear();
+    m_Series = -1;
+    env->CallVoidMethod( reader, getMethod( env, reader, "close", "()V" ) );
+    checkJavaException( env, "ImageReader.close" );
+    env->CallVoidMethod( reader, getMethod( env, reader, "setId", "(Ljava/lang/String;)V" ),
+                         env->NewStringUTF( fileName.c_str() ) );
+    checkJavaException( env, "ImageReader.setId" );
+    m_FileName = fileName;
+    }
+
+  if( series != m_Series )
+    {
+    env->CallVoidMethod( reader, getMethod( env, reader, "setSeries", "(I)V" ), series );
+    checkJavaException( env, "ImageReader.setSeries" );
+    m_Series = series;
+    }
+}
+
+void
+SCIFIOJNIReader::Close()
+{
+  if( !this->IsOpen() )
+    {
+    return;
+    }
+  AttachedThread env( getJavaVM( m_JavaHome, m_JavaOptions ) );
+  auto reader = static_cast< jobject >( m_Reader );
+  m_FileName.clear();
+  m_Series = -1;
+  env->CallVoidMethod( reader, getMethod( env, reader, "close", "()V" ) );
+  checkJavaException( env, "ImageReader.close" );
+}
+
+int
+SCIFIOJNIReader::GetSeriesCount() const
+{
+  if( !this->IsOpen() )
+    {
+    itkExceptionMacro(<< "No file is open");
+    }
+  AttachedThread env( getJavaVM( m_JavaHome, m_JavaOptions ) );
+  return callInt( env, static_cast< jobject >( m_Reader ), "getSeriesCount" );
+}
+
+void
+SCIFIOJNIReader::GetSeriesMetadata(MetaDataDictionary & dict) const
+{
+  if( !this->IsOpen() )
+    {
+    itkExceptionMacro(<< "No file is open");
+    }
+  AttachedThread env( getJavaVM( m_JavaHome, m_JavaOptions ) );
+  auto reader = static_cast< jobject >( m_Reader );
+  auto metadata = static_cast< jobject >( m_Metadata );
+
+  const char * sizeGetters[] = { "getSizeX", "getSizeY", "getSizeZ", "getSizeT", "getEffectiveSizeC" };
+  const double physicalSizes[] = {
+    physicalSize( env, metadata, "getPixelsPhysicalSizeX", "(I)Lome/units/quantity/Length;", m_Series ),
+    physicalSize( env, metadata, "getPixelsPhysicalSizeY", "(I)Lome/units/quantity/Length;", m_Series ),
+    physicalSize( env, metadata, "getPixelsPhysicalSizeZ", "(I)Lome/units/quantity/Length;", m_Series ),
+    physicalSize( env, metadata, "getPixelsTimeIncrement", "(I)Lome/units/quantity/Time;", m_Series ),
+    1.0
+  };
+  const char * axes = "XYZTC";
+  for( unsigned int i = 0; i < 5; ++i )
+    {
+    EncapsulateMetaData< std::string >( dict, std::string( "Size" ) + axes[i],
+                                        toString( callInt( env, reader, sizeGetters[i] ) ) );
+    EncapsulateMetaData< std::string >( dict, std::string( "PixelsPhysicalSize" ) + axes[i],
+                                        toString( physicalSizes[i] ) );
+    }
+  EncapsulateMetaData< std::string >( dict, "PixelType", toString( callInt( env, reader, "getPixelType" ) ) );
+  EncapsulateMetaData< std::string >( dict, "RGBChannelCount",
+                                      toString( callInt( env, reader, "getRGBChannelCount" ) ) );
+  // ReadRegion interleaves the components of planar RGB files.
+  EncapsulateMetaData< std::string >( dict, "Interleaved", "true" );
+  EncapsulateMetaData< std::string >( dict, "LittleEndian",
+                                      callBoolean( env, reader, "isLittleEndian" ) ? "true" : "false" );
+
+  auto dimensionOrder = static_cast< jstring >(
+    env->CallObjectMethod( reader, getMethod( env, reader, "getDimensionOrder", "()Ljava/lang/String;" ) ) );
+  checkJavaException( env, "getDimensionOrder" );
+  const char * chars = env->GetStringUTFChars( dimensionOrder, nullptr );
+  EncapsulateMetaData< std::string >( dict, "DimensionOrder", chars );
+  env->ReleaseStringUTFChars( dimensionOrder, chars );
+
+  EncapsulateMetaData< std::string >( dict, "UseLUT", callBoolean( env, reader, "isIndexed" ) ? "true" : "false" );
+  EncapsulateMetaData< std::string >( dict, "SeriesCount", toString( callInt( env, reader, "getSeriesCount" ) ) );
+}
+
+void
+SCIFIOJNIReader::ReadRegion(void * buffer, const ImageIORegion & region) const
+{
+  if( !this->IsOpen() )
+    {
+    itkExceptionMacro(<< "No file is open");
+    }
+  AttachedThread env( getJavaVM( m_JavaHome, m_JavaOptions ) );
+  auto reader = static_cast< jobject >( m_Reader );
+
+  const SizeValueType sampleBytes = bytesPerSample( callInt( env, reader, "getPixelType" ) );
+  const SizeValueType samples = callInt( env, reader, "getRGBChannelCount" );
+  const bool interleaved = samples == 1 || callBoolean( env, reader, "isInterleaved" );
+  const jmethodID getIndex = getMethod( env, reader, "getIndex", "(III)I" );
+  const jmethodID openBytes = getMethod( env, reader, "openBytes", "(I[BIIII)[B" );
+  jclass byteBufferClass = env->FindClass( "java/nio/ByteBuffer" );
+  const jmethodID put = env->GetMethodID( byteBufferClass, "put", "([BII)Ljava/nio/ByteBuffer;" );
+  checkJavaException( env, "ByteBuffer.put" );
+
+  const IndexValueType x0 = region.GetIndex( 0 );
+  const IndexValueType y0 = region.GetIndex( 1 );
+  const SizeValueType  sizeX = region.GetSize( 0 );
+  const SizeValueType  sizeY = region.GetSize( 1 );
+  const SizeValueType  rowBytes = sizeX * samples * sampleBytes;
+  const SizeValueType  rowsPerStrip = std::min( sizeY, m_MaximumTransferSize / rowBytes );
+  if( rowsPerStrip == 0 )
+    {
+    itkExceptionMacro(<< "Rows of " << rowBytes << " bytes exceed the maximum transfer size of "
+                      << m_MaximumTransferSize << " bytes");
+    }
+
+  // Bio-Formats decodes into a Java array, reused for every strip, which
+  // Java then copies into the caller's buffer.
+  auto strip = env->NewByteArray( static_cast< jsize >( rowsPerStrip * rowBytes ) );
+  checkJavaException( env, "allocating a strip" );
+  std::vector< char > planar( interleaved ? 0 : rowsPerStrip * rowBytes );
+
+  char * data = static_cast< char * >( buffer );
+  const IndexValueType endY = y0 + static_cast< IndexValueType >( sizeY );
+  for( SizeValueType c = 0; c < region.GetSize( 4 ); ++c )
+    {
+    for( SizeValueType t = 0; t < region.GetSize( 3 ); ++t )
+      {
+      for( SizeValueType z = 0; z < region.GetSize( 2 ); ++z )
+        {
+        const jint plane = env->CallIntMethod( reader, getIndex,
+                                               static_cast< jint >( region.GetIndex( 2 ) + z ),
+                                               static_cast< jint >( region.GetIndex( 4 ) + c ),
+                                               static_cast< jint >( region.GetIndex( 3 ) + t ) );
+        checkJavaException( env, "ImageReader.getIndex" );
+        for( IndexValueType y = y0; y < endY; y += rowsPerStrip )
+          {
+          const SizeValueType rows = std::min< SizeValueType >( rowsPerStrip, endY - y );
+          const SizeValueType bytes = rows * rowBytes;
+          jobject decoded = env->CallObjectMethod( reader, openBytes, plane, strip,
+                                                   static_cast< jint >( x0 ), static_cast< jint >( y ),
+                                                   static_cast< jint >( sizeX ), static_cast< jint >( rows ) );
+          checkJavaException( env, "ImageReader.openBytes" );
+          env->DeleteLocalRef( decoded );
+
+          if( interleaved )
+            {
+            jobject target = env->NewDirectByteBuffer( data, static_cast< jlong >( bytes ) );
+            if( target == nullptr )
+              {
+              checkJavaException( env, "NewDirectByteBuffer" );
+              itkExceptionMacro(<< "The JVM does not support direct buffers");
+              }
+            jobject result = env->CallObjectMethod( target, put, strip, 0, static_cast< jint >( bytes ) );
+            checkJavaException( env, "ByteBuffer.put" );
+            env->DeleteLocalRef( result );
+            env->DeleteLocalRef( target );
+            }
+          else
+            {
+            // Planar RGB comes one component after the other.
+            env->GetByteArrayRegion( strip, 0, static_cast< jsize >( bytes ), reinterpret_cast< jbyte * >( &planar[0] ) );
+            const SizeValueType pixels = rows * sizeX;
+            for( SizeValueType s = 0; s < samples; ++s )
+              {
+              for( SizeValueType p = 0; p < pixels; ++p )
+                {
+                memcpy( data + ( p * samples + s ) * sampleBytes, &planar[( s * pixels + p ) * sampleBytes], sampleBytes );
+                }
+              }
+            }
+          data += bytes;
+          }
+        }
+      }
+    }
+}
+
+#else
+
+SCIFIOJNIReader::~SCIFIOJNIReader() = default;
+
+bool
+SCIFIOJNIReader::CanRead(const std::string &)
+{
+  unavailable();
+}
+
+void
+SCIFIOJNIReader::Open(const std::string &, int)
+{
+  unavailable();
+}
+
+void
+SCIFIOJNIReader::Close()
+{
+}
+
+int
+SCIFIOJNIReader::GetSeriesCount() const
+{
+  unavailable();
+}
+
+void
+SCIFIOJNIReader::GetSeriesMetadata(MetaDataDictionary &) const
+{
+  unavailable();
+}
+
+void
+SCIFIOJNIReader::ReadRegion(void *, const ImageIORegion &) const
+{
+  unavailable();
+}
+
+#endif
+
+void
+SCIFIOJNIReader::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "JavaHome: " << m_JavaHome << std::endl;
+  os << indent << "JavaOptions:";
+  for( const std::string & option : m_JavaOptions )
+    {
+    os << " " << option;
+    }
+  os << std::endl;
+  os << indent << "FileName: " << m_FileName << std::endl;
+  os << indent << "Series: " << m_Series << std::endl;
+  os << indent << "MaximumTransferSize: " << m_MaximumTransferSize << std::endl;
+}
+
+} // end namespace itk
@@ -0,0 +1,473 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSCIFIOMetadataCatalog.h"
+#include "itkSCIFIOChunkCache.h"
+#include "itkSCIFIOImageIO.h"
+#include "itkMetaDataObject.h"
+
+#include "itksys/Directory.hxx"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+  const char * const CatalogMagic = "SCIFIOMetadataCatalog";
+  // Version 1 kept whole-second modification times. Its entries are still
+  // loaded, and are refreshed by the next IndexDirectory(), as their times
+  // never match.
+  const int CatalogVersion = 2;
+
+  // Catalog files hold one record per line, with tab-separated fields, so
+  // backslashes, tabs and newlines within fields are escaped.
+  std::string escape( const std::string & s )
+  {
+    std::string result;
+    result.reserve( s.size() );
+    for( char c : s )
+      {
+      switch( c )
+        {
+        case '\\':
+          result += "\\\\";
+          break;
+        case '\t':
+          result += "\\t";
+          break;
+        case '\n':
+          result += "\\n";
+          break;
+        default:
+          result += c;
+        }
+      }
+    return result;
+  }
+
+  std::string unescape( const std::string & s )
+  {
+    std::string result;
+    result.reserve( s.size() );
+    for( size_t i = 0; i < s.size(); ++i )
+      {
+      if( s[i] != '\\' || i + 1 == s.size() )
+        {
+        result += s[i];
+        continue;
+        }
+      ++i;
+      switch( s[i] )
+        {
+        case 't':
+          result += '\t';
+          break;
+        case 'n':
+          result += '\n';
+          break;
+        default:
+          result += s[i];
+        }
+      }
+    return result;
+  }
+
+  std::vector<std::string> splitFields( const std::string & line )
+  {
+    std::vector<std::string> fields;
+    std::stringstream ss( line );
+    std::string field;
+    while( std::getline( ss, field, '\t' ) )
+      {
+      fields.push_back( unescape( field ) );
+      }
+    return fields;
+  }
+}
+
+namespace itk
+{
+SCIFIOMetadataCatalog::SCIFIOMetadataCatalog()
+{
+  const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+  m_NumberOfWorkers = std::max( 1u, std::min( 4u, hardwareThreads ) );
+}
+
+const std::vector< std::string > &
+SCIFIOMetadataCatalog::GetCoreMetadataKeys()
+{
+  // The keys SCIFIOImageIO needs to set up a read without asking the bridge.
+  static const std::vector< std::string > keys = {
+    "SizeX", "SizeY", "SizeZ", "SizeT", "SizeC",
+    "PixelsPhysicalSizeX", "PixelsPhysicalSizeY", "PixelsPhysicalSizeZ",
+    "PixelsPhysicalSizeT", "PixelsPhysicalSizeC",
+    "PixelType", "RGBChannelCount", "Interleaved", "LittleEndian",
+    "DimensionOrder", "UseLUT"
+  };
+  return keys;
+}
+
+bool
+SCIFIOMetadataCatalog::IsUpToDate(const EntryType & entry) const
+{
+  if( !itksys::SystemTools::FileExists( entry.FileName, true ) )
+    {
+    return false;
+    }
+  return SCIFIOChunkCache::GetModifiedTime( entry.FileName ) == entry.ModifiedTime
+    && SCIFIOChunkCache::GetFileLength( entry.FileName ) == entry.FileLength;
+}
+
+bool
+SCIFIOMetadataCatalog::GetEntry(const std::string & fileName, EntryType & entry) const
+{
+  const std::string fullPath = itksys::SystemTools::CollapseFullPath( fileName );
+
+  // The entry is copied under the lock: SetEntry(), Load(), Clear() and
+  // IndexDirectory() may replace or remove it from other threads.
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  auto it = m_Entries.find( fullPath );
+  if( it == m_Entries.end() || !this->IsUpToDate( it->second ) )
+    {
+    return false;
+    }
+  entry = it->second;
+  return true;
+}
+
+SCIFIOMetadataCatalog::EntryMapType
+SCIFIOMetadataCatalog::GetEntries() const
+{
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  return m_Entries;
+}
+
+bool
+SCIFIOMetadataCatalog::GetSeriesMetadata(const std::string & fileName, int series, MetaDataDictionary & dict) const
+{
+  EntryType entry;
+  if( !this->GetEntry( fileName, entry ) || series < 0 || series >= static_cast< int >( entry.Series.size() ) )
+    {
+    return false;
+    }
+  for( const auto & keyValue : entry.Series[series] )
+    {
+    EncapsulateMetaData< std::string >( dict, keyValue.first, keyValue.second );
+    }
+  return true;
+}
+
+void
+SCIFIOMetadataCatalog::SetEntry(const EntryType & entry)
+{
+  EntryType fullPathEntry = entry;
+  fullPathEntry.FileName = itksys::SystemTools::CollapseFullPath( entry.FileName );
+
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  m_Entries[fullPathEntry.FileName] = fullPathEntry;
+  this->Modified();
+}
+
+void
+SCIFIOMetadataCatalog::Clear()
+{
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  m_Entries.clear();
+  this->Modified();
+}
+
+void
+SCIFIOMetadataCatalog::Load(const std::string & fileName)
+{
+  std::ifstream in( fileName.c_str() );
+  if( !in )
+    {
+    itkExceptionMacro(<< "Cannot open catalog file " << fileName);
+    }
+
+  std::string line;
+  std::getline( in, line );
+  std::vector< std::string > header = splitFields( line );
+  if( header.size() != 2 || header[0] != CatalogMagic )
+    {
+    itkExceptionMacro(<< fileName << " is not a SCIFIO metadata catalog");
+    }
+  const int version = std::atoi( header[1].c_str() );
+  if( version != 1 && version != CatalogVersion )
+    {
+    itkExceptionMacro(<< "Unsupported SCIFIO metadata catalog version " << header[1] << " in " << fileName);
+    }
+
+  // Each file record is followed by one line per series, holding the
+  // series' metadata as alternating keys and values.
+  EntryMapType entries;
+  while( std::getline( in, line ) )
+    {
+    if( line.empty() )
+      {
+      continue;
+      }
+    std::vector< std::string > fields = splitFields( line );
+    if( fields.size() != 4 )
+      {
+      itkExceptionMacro(<< "Corrupt record in SCIFIO metadata catalog " << fileName << ": " << line);
+      }
+    EntryType entry;
+    entry.FileName = fields[0];
+    entry.ModifiedTime = fields[1];
+    entry.FileLength = std::strtoull( fields[2].c_str(), nullptr, 10 );
+    const int seriesCount = std::atoi( fields[3].c_str() );
+
+    for( int series = 0; series < seriesCount; ++series )
+      {
+      if( !std::getline( in, line ) )
+        {
+        itkExceptionMacro(<< "Truncated SCIFIO metadata catalog " << fileName);
+        }
+      std::vector< std::string > keyValues = splitFields( line );
+      SeriesMetadataType metadata;
+      for( size_t i = 0; i + 1 < keyValues.size(); i += 2 )
+        {
+        metadata[keyValues[i]] = keyValues[i + 1];
+        }
+      entry.Series.push_back( metadata );
+      }
+    entries[entry.FileName] = entry;
+    }
+
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  m_Entries.swap( entries );
+  this->Modified();
+}
+
+void
+SCIFIOMetadataCatalog::Save(const std::string & fileName) const
+{
+  // Write to a temporary file first, so that a crash never leaves a
+  // truncated catalog behind.
+  const std::string tmpFileName = fileName + ".tmp";
+  {
+  std::ofstream out( tmpFileName.c_str() );
+  if( !out )
+    {
+    itkExceptionMacro(<< "Cannot write catalog file " << tmpFileName);
+    }
+
+  out << CatalogMagic << "\t" << CatalogVersion << "\n";
+
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  for( const auto & it : m_Entries )
+    {
+    const EntryType & entry = it.second;
+    out << escape( entry.FileName ) << "\t" << entry.ModifiedTime << "\t"
+        << entry.FileLength << "\t" << entry.Series.size() << "\n";
+    for( const SeriesMetadataType & metadata : entry.Series )
+      {
+      bool first = true;
+      for( const auto & keyValue : metadata )
+        {
+        out << ( first ? "" : "\t" ) << escape( keyValue.first ) << "\t" << escape( keyValue.second );
+        first = false;
+        }
+      out << "\n";
+      }
+    }
+  if( !out )
+    {
+    itkExceptionMacro(<< "Error while writing catalog file " << tmpFileName);
+    }
+  }
+
+  itksys::SystemTools::RemoveFile( fileName );
+  if( !itksys::SystemTools::RenameFile( tmpFileName, fileName ) )
+    {
+    itkExceptionMacro(<< "Cannot rename " << tmpFileName << " to " << fileName);
+    }
+}
+
+void
+SCIFIOMetadataCatalog::ListFiles(const std::string & directory, std::vector< std::string > & files) const
+{
+  itksys::Directory dir;
+  if( !dir.Load( directory ) )
+    {
+    itkWarningMacro(<< "Cannot list directory " << directory);
+    return;
+    }
+  for( unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i )
+    {
+    const std::string name = dir.GetFile( i );
+    if( name == "." || name == ".." )
+      {
+      continue;
+      }
+    const std::string path = directory + "/" + name;
+    if( itksys::SystemTools::FileIsDirectory( path ) )
+      {
+      if( m_Recursive && !itksys::SystemTools::FileIsSymlink( path ) )
+        {
+        this->ListFiles( path, files );
+        }
+      }
+    else
+      {
+      files.push_back( itksys::SystemTools::CollapseFullPath( path ) );
+      }
+    }
+}
+
+void
+SCIFIOMetadataCatalog::IndexDirectory(const std::string & directory)
+{
+  const std::string root = itksys::SystemTools::CollapseFullPath( directory );
+
+  std::vector< std::string > files;
+  this->ListFiles( root, files );
+  std::sort( files.begin(), files.end() );
+
+  // Forget the files under the directory that are gone.
+  {
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  const std::string prefix = root + "/";
+  for( auto it = m_Entries.begin(); it != m_Entries.end(); )
+    {
+    if( it->first.compare( 0, prefix.size(), prefix ) == 0
+        && !std::binary_search( files.begin(), files.end(), it->first ) )
+      {
+      it = m_Entries.erase( it );
+      }
+    else
+      {
+      ++it;
+      }
+    }
+  }
+
+  // Only probe what is new or has changed.
+  std::vector< std::string > toProbe;
+  EntryType upToDate;
+  for( const std::string & file : files )
+    {
+    if( !this->GetEntry( file, upToDate ) )
+      {
+      toProbe.push_back( file );
+      }
+    }
+  m_NumberOfProbedFiles = toProbe.size();
+  itkDebugMacro(<< "Indexing " << root << ": " << files.size() << " files, "
+                << toProbe.size() << " to probe");
+
+  if( toProbe.empty() )
+    {
+    return;
+    }
+
+  // Each worker owns one SCIFIOImageIO, and thus one bridge process, and
+  // pulls the next file to probe from a shared counter.
+  const unsigned int numberOfWorkers = std::max( 1u,
+    std::min( m_NumberOfWorkers, static_cast< unsigned int >( toProbe.size() ) ) );
+  std::vector< SCIFIOImageIO::Pointer > ios;
+  for( unsigned int i = 0; i < numberOfWorkers; ++i )
+    {
+    ios.push_back( SCIFIOImageIO::New() );
+    }
+
+  std::atomic< size_t > next( 0 );
+  auto worker = [this, &toProbe, &next]( SCIFIOImageIO::Pointer io )
+    {
+    for( size_t i = next++; i < toProbe.size(); i = next++ )
+      {
+      EntryType entry;
+      entry.FileName = toProbe[i];
+      entry.ModifiedTime = SCIFIOChunkCache::GetModifiedTime( entry.FileName );
+      entry.FileLength = SCIFIOChunkCache::GetFileLength( entry.FileName );
+      try
+        {
+        if( io->CanReadFile( entry.FileName.c_str() ) )
+          {
+          io->SetFileName( entry.FileName );
+          io->ReadImageInformation();
+          const int seriesCount = io->GetSeriesCount();
+          for( int series = 0; series < seriesCount; ++series )
+            {
+            if( series > 0 )
+              {
+              io->SetSeries( series );
+              io->ReadImageInformation();
+              }
+            const MetaDataDictionary & dict = io->GetMetaDataDictionary();
+            SeriesMetadataType metadata;
+            for( const std::string & key : GetCoreMetadataKeys() )
+              {
+              std::string value;
+              if( ExposeMetaData< std::string >( dict, key, value ) )
+                {
+                metadata[key] = value;
+                }
+              }
+            entry.Series.push_back( metadata );
+            }
+          if( seriesCount > 1 )
+            {
+            io->SetSeries( 0 );
+            }
+          }
+        }
+      catch( ExceptionObject & e )
+        {
+        // The failure may be transient (I/O, or the bridge dying), so the
+        // file is left out of the catalog, to be probed again next time. The
+        // bridge was stopped, and the next file gets a fresh IO.
+        itkWarningMacro(<< "Cannot index " << entry.FileName << ": " << e.GetDescription());
+        io = SCIFIOImageIO::New();
+        continue;
+        }
+      this->SetEntry( entry );
+      }
+    };
+
+  std::vector< std::thread > workers;
+  for( unsigned int i = 1; i < numberOfWorkers; ++i )
+    {
+    workers.emplace_back( worker, ios[i] );
+    }
+  worker( ios[0] );
+  for( std::thread & t : workers )
+    {
+    t.join();
+    }
+}
+
+void
+SCIFIOMetadataCatalog::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  {
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  os << indent << "NumberOfEntries: " << m_Entries.size() << std::endl;
+  }
+  os << indent << "NumberOfWorkers: " << m_NumberOfWorkers << std::endl;
+  os << indent << "Recursive: " << m_Recursive << std::endl;
+  os << indent << "NumberOfProbedFiles: " << m_NumberOfProbedFiles << std::endl;
+}
+} // end namespace itk
@@ -0,0 +1,672 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSCIFIOOMETIFFReader.h"
+#include "itkMetaDataObject.h"
+
+#include "itksys/SystemTools.hxx"
+
+#include "itk_expat.h"
+#include "itk_tiff.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+  using AttributesType = std::map< std::string, std::string >;
+
+  struct OMETiffData
+  {
+    AttributesType Attributes;
+    std::string    FileName;
+  };
+
+  struct OMEImage
+  {
+    AttributesType              Pixels;
+    unsigned int                SamplesPerPixel{ 1 };
+    std::vector< OMETiffData >  TiffData;
+  };
+
+  // Collects the elements of the OME-XML that describe the pixels.
+  struct OMEParser
+  {
+    std::vector< OMEImage > Images;
+    bool                    InPixels{ false };
+    bool                    InTiffData{ false };
+
+    static std::string LocalName( const XML_Char * name )
+    {
+      const char * colon = strrchr( name, ':' );
+      return colon ? colon + 1 : name;
+    }
+
+    static AttributesType Attributes( const XML_Char ** attributes )
+    {
+      AttributesType result;
+      for( ; attributes[0] != nullptr; attributes += 2 )
+        {
+        result[LocalName( attributes[0] )] = attributes[1];
+        }
+      return result;
+    }
+
+    static void StartElement( void * userData, const XML_Char * name, const XML_Char ** attributes )
+    {
+      OMEParser * parser = static_cast< OMEParser * >( userData );
+      const std::string element = LocalName( name );
+      if( element == "Image" )
+        {
+        parser->Images.emplace_back();
+        }
+      else if( parser->Images.empty() )
+        {
+        return;
+        }
+      else if( element == "Pixels" )
+        {
+        parser->InPixels = true;
+        parser->Images.back().Pixels = Attributes( attributes );
+        }
+      else if( parser->InPixels && element == "Channel" )
+        {
+        const AttributesType channel = Attributes( attributes );
+        const auto samples = channel.find( "SamplesPerPixel" );
+        if( samples != channel.end() )
+          {
+          parser->Images.back().SamplesPerPixel = std::max( 1, atoi( samples->second.c_str() ) );
+          }
+        }
+      else if( parser->InPixels && element == "TiffData" )
+        {
+        parser->InTiffData = true;
+        parser->Images.back().TiffData.emplace_back();
+        parser->Images.back().TiffData.back().Attributes = Attributes( attributes );
+        }
+      else if( parser->InTiffData && element == "UUID" )
+        {
+        const AttributesType uuid = Attributes( attributes );
+        const auto fileName = uuid.find( "FileName" );
+        if( fileName != uuid.end() )
+          {
+          parser->Images.back().TiffData.back().FileName = fileName->second;
+          }
+        }
+    }
+
+    static void EndElement( void * userData, const XML_Char * name )
+    {
+      OMEParser * parser = static_cast< OMEParser * >( userData );
+      const std::string element = LocalName( name );
+      if( element == "Pixels" )
+        {
+        parser->InPixels = false;
+        }
+      else if( element == "TiffData" )
+        {
+        parser->InTiffData = false;
+        }
+    }
+
+    bool Parse( const std::string & xml )
+    {
+      XML_Parser parser = XML_ParserCreate( nullptr );
+      XML_SetUserData( parser, this );
+      XML_SetElementHandler( parser, &OMEParser::StartElement, &OMEParser::EndElement );
+      const bool parsed = XML_Parse( parser, xml.c_str(), static_cast< int >( xml.size() ), 1 ) != XML_STATUS_ERROR;
+      XML_ParserFree( parser );
+      return parsed;
+    }
+  };
+
+  long attribute( const AttributesType & attributes, const char * name, long defaultValue )
+  {
+    const auto it = attributes.find( name );
+    return it == attributes.end() ? defaultValue : atol( it->second.c_str() );
+  }
+
+  double physicalSize( const AttributesType & attributes, const char * name )
+  {
+    const auto it = attributes.find( name );
+    const double size = it == attributes.end() ? 0.0 : atof( it->second.c_str() );
+    return size > 0.0 ? size : 1.0;
+  }
+
+  // SCIFIO pixel type codes, as the bridge reports them.
+  int pixelTypeCode( std::string type )
+  {
+    std::transform( type.begin(), type.end(), type.begin(), ::tolower );
+    const char * types[] = { "int8", "uint8", "int16", "uint16", "int32", "uint32", "float", "double" };
+    for( int i = 0; i < 8; ++i )
+      {
+      if( type == types[i] )
+        {
+        return i;
+        }
+      }
+    return -1;
+  }
+
+  int sampleFormat( int pixelType )
+  {
+    switch( pixelType )
+      {
+      case 0:
+      case 2:
+      case 4:
+        return SAMPLEFORMAT_INT;
+      case 6:
+      case 7:
+        return SAMPLEFORMAT_IEEEFP;
+      default:
+        return SAMPLEFORMAT_UINT;
+      }
+  }
+
+  // Whether the current IFD holds planes of the given size and layout, in
+  // a way libtiff can decode. The strip and tile copies rely on it.
+  bool hasPlaneLayout( TIFF * file, uint32 width, uint32 height, uint16 samplesPerPixel,
+                       uint16 bitsPerSample, uint16 format )
+  {
+    uint32 ifdWidth = 0;
+    uint32 ifdHeight = 0;
+    uint16 ifdSamplesPerPixel = 1;
+    uint16 ifdBitsPerSample = 1;
+    uint16 ifdFormat = SAMPLEFORMAT_UINT;
+    uint16 planarConfig = PLANARCONFIG_CONTIG;
+    uint16 compression = COMPRESSION_NONE;
+    TIFFGetField( file, TIFFTAG_IMAGEWIDTH, &ifdWidth );
+    TIFFGetField( file, TIFFTAG_IMAGELENGTH, &ifdHeight );
+    TIFFGetFieldDefaulted( file, TIFFTAG_SAMPLESPERPIXEL, &ifdSamplesPerPixel );
+    TIFFGetFieldDefaulted( file, TIFFTAG_BITSPERSAMPLE, &ifdBitsPerSample );
+    TIFFGetFieldDefaulted( file, TIFFTAG_SAMPLEFORMAT, &ifdFormat );
+    TIFFGetFieldDefaulted( file, TIFFTAG_PLANARCONFIG, &planarConfig );
+    TIFFGetFieldDefaulted( file, TIFFTAG_COMPRESSION, &compression );
+    return ifdWidth == width && ifdHeight == height && ifdSamplesPerPixel == samplesPerPixel
+           && ifdBitsPerSample == bitsPerSample && ifdFormat == format
+           && ( samplesPerPixel == 1 || planarConfig == PLANARCONFIG_CONTIG )
+           && TIFFIsCODECConfigured( compression );
+  }
+}
+
+namespace itk
+{
+
+// A TIFF handle, closed when it goes out of scope.
+struct SCIFIOOMETIFFReader::TIFFHandle
+{
+  TIFF * File{ nullptr };
+  toff_t Offset{ 0 };
+
+  explicit TIFFHandle( const std::string & fileName )
+    : File( TIFFOpen( fileName.c_str(), "r" ) )
+  {}
+
+  ~TIFFHandle()
+  {
+    if( File != nullptr )
+      {
+      TIFFClose( File );
+      }
+  }
+
+  // Reads the IFD at an offset, without walking the chain of IFDs to it.
+  bool SetDirectoryOffset( toff_t offset )
+  {
+    if( Offset != offset )
+      {
+      Offset = TIFFSetSubDirectory( File, offset ) ? offset : 0;
+      }
+    return Offset == offset;
+  }
+};
+
+SCIFIOOMETIFFReader::SCIFIOOMETIFFReader()
+  : m_NumberOfWorkUnits( std::max( 1u, std::thread::hardware_concurrency() ) )
+{
+  std::fill( m_Sizes, m_Sizes + 5, 1 );
+  std::fill( m_PhysicalSizes, m_PhysicalSizes + 5, 1.0 );
+}
+
+SCIFIOOMETIFFReader::~SCIFIOOMETIFFReader() = default;
+
+bool
+SCIFIOOMETIFFReader::HasOMETIFFExtension(const std::string & fileName)
+{
+  const std::string lower = itksys::SystemTools::LowerCase( fileName );
+  const char * extensions[] = { ".ome.tif", ".ome.tiff", ".ome.tf2", ".ome.tf8", ".ome.btf" };
+  for( const char * extension : extensions )
+    {
+    const size_t length = strlen( extension );
+    if( lower.size() > length && lower.compare( lower.size() - length, length, extension ) == 0 )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+void
+SCIFIOOMETIFFReader::Close()
+{
+  m_FileName.clear();
+  m_Series = -1;
+  m_SeriesCount = 0;
+  m_PlaneIFDs.clear();
+  m_IFDOffsets.clear();
+  std::lock_guard< std::mutex > lock( m_HandlesMutex );
+  m_Handles.clear();
+}
+
+std::unique_ptr< SCIFIOOMETIFFReader::TIFFHandle >
+SCIFIOOMETIFFReader::AcquireHandle() const
+{
+  {
+  std::lock_guard< std::mutex > lock( m_HandlesMutex );
+  if( !m_Handles.empty() )
+    {
+    std::unique_ptr< TIFFHandle > handle = std::move( m_Handles.back() );
+    m_Handles.pop_back();
+    return handle;
+    }
+  }
+  std::unique_ptr< TIFFHandle > handle( new TIFFHandle( m_FileName ) );
+  if( handle->File == nullptr )
+    {
+    return nullptr;
+    }
+  return handle;
+}
+
+void
+SCIFIOOMETIFFReader::ReleaseHandle(std::unique_ptr< TIFFHandle > handle) const
+{
+  std::lock_guard< std::mutex > lock( m_HandlesMutex );
+  if( m_Handles.size() < std::max( 1u, m_NumberOfWorkUnits ) )
+    {
+    m_Handles.push_back( std::move( handle ) );
+    }
+}
+
+bool
+SCIFIOOMETIFFReader::Open(const std::string & fileName, int series)
+{
+  this->Close();
+
+  if( !HasOMETIFFExtension( fileName ) || !itksys::SystemTools::FileExists( fileName, true ) )
+    {
+    return false;
+    }
+
+  std::unique_ptr< TIFFHandle > tiff( new TIFFHandle( fileName ) );
+  char * description = nullptr;
+  if( tiff->File == nullptr || !TIFFGetField( tiff->File, TIFFTAG_IMAGEDESCRIPTION, &description ) )
+    {
+    itkDebugMacro(<< fileName << " has no ImageDescription");
+    return false;
+    }
+
+  OMEParser ome;
+  if( !ome.Parse( description ) || series < 0 || series >= static_cast< int >( ome.Images.size() ) )
+    {
+    itkDebugMacro(<< fileName << " has no OME-XML for series " << series);
+    return false;
+    }
+  const OMEImage & image = ome.Images[series];
+
+  m_PixelType = pixelTypeCode( image.Pixels.count( "Type" ) ? image.Pixels.at( "Type" ) : "" );
+  if( m_PixelType < 0 )
+    {
+    return false;
+    }
+  m_BytesPerSample = m_PixelType < 2 ? 1 : m_PixelType < 4 ? 2 : m_PixelType < 7 ? 4 : 8;
+
+  // SizeC counts the samples of RGB channels; planes are per channel.
+  m_SamplesPerPixel = image.SamplesPerPixel;
+  const char * sizeNames[] = { "SizeX", "SizeY", "SizeZ", "SizeT", "SizeC" };
+  for( unsigned int i = 0; i < 5; ++i )
+    {
+    m_Sizes[i] = std::max( 1L, attribute( image.Pixels, sizeNames[i], 1 ) );
+    }
+  if( m_Sizes[4] % m_SamplesPerPixel != 0 )
+    {
+    return false;
+    }
+  m_Sizes[4] /= m_SamplesPerPixel;
+
+  m_PhysicalSizes[0] = physicalSize( image.Pixels, "PhysicalSizeX" );
+  m_PhysicalSizes[1] = physicalSize( image.Pixels, "PhysicalSizeY" );
+  m_PhysicalSizes[2] = physicalSize( image.Pixels, "PhysicalSizeZ" );
+  m_PhysicalSizes[3] = physicalSize( image.Pixels, "TimeIncrement" );
+  m_PhysicalSizes[4] = 1.0;
+
+  m_DimensionOrder = image.Pixels.count( "DimensionOrder" ) ? image.Pixels.at( "DimensionOrder" ) : "XYZCT";
+  if( m_DimensionOrder.size() != 5 || m_DimensionOrder.compare( 0, 2, "XY" ) != 0 )
+    {
+    return false;
+    }
+
+  // Strides of Z, T and C in the plane numbering of the dimension order.
+  const SizeValueType numberOfPlanes = m_Sizes[2] * m_Sizes[3] * m_Sizes[4];
+  SizeValueType strides[5] = { 0, 0, 0, 0, 0 };
+  SizeValueType stride = 1;
+  for( unsigned int i = 2; i < 5; ++i )
+    {
+    const unsigned int axis = std::string( "XYZTC" ).find( m_DimensionOrder[i] );
+    if( axis < 2 || axis > 4 || strides[axis] != 0 )
+      {
+      return false;
+      }
+    strides[axis] = stride;
+    stride *= m_Sizes[axis];
+    }
+
+  // Map the planes to IFDs, as the TiffData elements describe.
+  std::vector< long > planeIFDs( numberOfPlanes, -1 );
+  if( image.TiffData.empty() )
+    {
+    for( SizeValueType plane = 0; plane < numberOfPlanes; ++plane )
+      {
+      planeIFDs[plane] = plane;
+      }
+    }
+  const std::string baseName = itksys::SystemTools::GetFilenameName( fileName );
+  for( const OMETiffData & tiffData : image.TiffData )
+    {
+    if( !tiffData.FileName.empty() && tiffData.FileName != baseName )
+      {
+      itkDebugMacro(<< fileName << " has planes in " << tiffData.FileName);
+      return false;
+      }
+    const long ifd = attribute( tiffData.Attributes, "IFD", 0 );
+    const SizeValueType first = attribute( tiffData.Attributes, "FirstZ", 0 ) * strides[2]
+      + attribute( tiffData.Attributes, "FirstT", 0 ) * strides[3]
+      + attribute( tiffData.Attributes, "FirstC", 0 ) * strides[4];
+    // Without a PlaneCount, a TiffData with no attributes covers every
+    // plane, and one with an IFD covers that IFD only.
+    const long planeCount = attribute( tiffData.Attributes, "PlaneCount",
+                                       tiffData.Attributes.empty() ? numberOfPlanes : 1 );
+    for( long i = 0; i < planeCount && first + i < numberOfPlanes; ++i )
+      {
+      planeIFDs[first + i] = ifd + i;
+      }
+    }
+
+  // Walk the chain of IFDs once, recording where each one is, so that
+  // reads seek straight to the IFDs of their planes, and check that every
+  // IFD holding planes has the layout the OME-XML gives.
+  std::vector< bool > holdsPlanes;
+  for( long ifd : planeIFDs )
+    {
+    if( ifd < 0 )
+      {
+      itkDebugMacro(<< fileName << " has planes that are not mapped to an IFD");
+      return false;
+      }
+    if( static_cast< size_t >( ifd ) >= holdsPlanes.size() )
+      {
+      holdsPlanes.resize( ifd + 1, false );
+      }
+    holdsPlanes[ifd] = true;
+    }
+  std::vector< std::uint64_t > offsets;
+  do
+    {
+    const size_t ifd = offsets.size();
+    offsets.push_back( TIFFCurrentDirOffset( tiff->File ) );
+    if( ifd < holdsPlanes.size() && holdsPlanes[ifd]
+        && !hasPlaneLayout( tiff->File, static_cast< uint32 >( m_Sizes[0] ), static_cast< uint32 >( m_Sizes[1] ),
+                            static_cast< uint16 >( m_SamplesPerPixel ), static_cast< uint16 >( 8 * m_BytesPerSample ),
+                            static_cast< uint16 >( sampleFormat( m_PixelType ) ) ) )
+      {
+      itkDebugMacro(<< fileName << " has IFD " << ifd << " that is not read natively");
+      return false;
+      }
+    }
+  while( offsets.size() < holdsPlanes.size() && TIFFReadDirectory( tiff->File ) );
+  if( offsets.size() < holdsPlanes.size() )
+    {
+    itkDebugMacro(<< fileName << " has planes mapped to IFDs it does not have");
+    return false;
+    }
+
+  m_PlaneIFDs.assign( planeIFDs.begin(), planeIFDs.end() );
+  m_IFDOffsets = offsets;
+  m_FileName = fileName;
+  m_Series = series;
+  m_SeriesCount = static_cast< int >( ome.Images.size() );
+  this->ReleaseHandle( std::move( tiff ) );
+  return true;
+}
+
+void
+SCIFIOOMETIFFReader::GetSeriesMetadata(MetaDataDictionary & dict) const
+{
+  const char * axes = "XYZTC";
+  for( unsigned int i = 0; i < 5; ++i )
+    {
+    std::ostringstream size;
+    size << m_Sizes[i];
+    EncapsulateMetaData< std::string >( dict, std::string( "Size" ) + axes[i], size.str() );
+    std::ostringstream physicalSize;
+    physicalSize << m_PhysicalSizes[i];
+    EncapsulateMetaData< std::string >( dict, std::string( "PixelsPhysicalSize" ) + axes[i], physicalSize.str() );
+    }
+  std::ostringstream pixelType;
+  pixelType << m_PixelType;
+  EncapsulateMetaData< std::string >( dict, "PixelType", pixelType.str() );
+  std::ostringstream samplesPerPixel;
+  samplesPerPixel << m_SamplesPerPixel;
+  EncapsulateMetaData< std::string >( dict, "RGBChannelCount", samplesPerPixel.str() );
+  EncapsulateMetaData< std::string >( dict, "Interleaved", m_SamplesPerPixel > 1 ? "true" : "false" );
+  // libtiff hands pixels over in native byte order.
+  const int one = 1;
+  const bool littleEndian = *reinterpret_cast< const char * >( &one ) == 1;
+  EncapsulateMetaData< std::string >( dict, "LittleEndian", littleEndian ? "true" : "false" );
+  EncapsulateMetaData< std::string >( dict, "DimensionOrder", m_DimensionOrder );
+  EncapsulateMetaData< std::string >( dict, "UseLUT", "false" );
+}
+
+void
+SCIFIOOMETIFFReader::ReadRegion(void * buffer, const ImageIORegion & region) const
+{
+  if( !this->IsOpen() )
+    {
+    itkExceptionMacro(<< "No OME-TIFF file is open");
+    }
+
+  const SizeValueType pixelBytes = m_BytesPerSample * m_SamplesPerPixel;
+  const SizeValueType x0 = region.GetIndex( 0 );
+  const SizeValueType sizeX = region.GetSize( 0 );
+  const SizeValueType y0 = region.GetIndex( 1 );
+  const SizeValueType sizeY = region.GetSize( 1 );
+  const SizeValueType rowBytes = sizeX * pixelBytes;
+
+  // Plane numbers of the region's planes, in XYZTC order, as in the buffer.
+  SizeValueType strides[5] = { 0, 0, 1, 1, 1 };
+  SizeValueType stride = 1;
+  for( unsigned int i = 2; i < 5; ++i )
+    {
+    const unsigned int axis = std::string( "XYZTC" ).find( m_DimensionOrder[i] );
+    strides[axis] = stride;
+    stride *= m_Sizes[axis];
+    }
+  std::vector< SizeValueType > planes;
+  for( SizeValueType c = 0; c < region.GetSize( 4 ); ++c )
+    {
+    for( SizeValueType t = 0; t < region.GetSize( 3 ); ++t )
+      {
+      for( SizeValueType z = 0; z < region.GetSize( 2 ); ++z )
+        {
+        planes.push_back( ( region.GetIndex( 2 ) + z ) * strides[2] + ( region.GetIndex( 3 ) + t ) * strides[3]
+                          + ( region.GetIndex( 4 ) + c ) * strides[4] );
+        }
+      }
+    }
+
+  // Work is split into bands of rows of each plane, as tall as the strips
+  // or tiles of the first IFD, so that each is decoded once.
+  SizeValueType bandRows = sizeY;
+  {
+  std::unique_ptr< TIFFHandle > tiff = this->AcquireHandle();
+  if( !tiff || !tiff->SetDirectoryOffset( m_IFDOffsets[m_PlaneIFDs[planes[0]]] ) )
+    {
+    itkExceptionMacro(<< "Cannot open " << m_FileName);
+    }
+  uint32 rows = 0;
+  if( TIFFIsTiled( tiff->File ) ? TIFFGetField( tiff->File, TIFFTAG_TILELENGTH, &rows )
+                                : TIFFGetFieldDefaulted( tiff->File, TIFFTAG_ROWSPERSTRIP, &rows ) )
+    {
+    bandRows = std::max< SizeValueType >( 1, std::min< SizeValueType >( rows, m_Sizes[1] ) );
+    }
+  this->ReleaseHandle( std::move( tiff ) );
+  }
+  const SizeValueType firstBand = y0 / bandRows;
+  const SizeValueType bandsPerPlane = ( y0 + sizeY - 1 ) / bandRows - firstBand + 1;
+  const SizeValueType numberOfItems = planes.size() * bandsPerPlane;
+
+  std::atomic< SizeValueType > nextItem( 0 );
+  std::atomic< bool > failed( false );
+  std::mutex errorMutex;
+  std::string error;
+  auto fail = [&]( const std::string & message )
+    {
+    std::lock_guard< std::mutex > lock( errorMutex );
+    error = message;
+    failed = true;
+    };
+
+  auto decode = [&]( TIFFHandle & tiff )
+    {
+    std::vector< char > scratch;
+    for( SizeValueType item = nextItem++; item < numberOfItems && !failed; item = nextItem++ )
+      {
+      const SizeValueType planeIndex = item / bandsPerPlane;
+      const SizeValueType bandStart = std::max( y0, ( firstBand + item % bandsPerPlane ) * bandRows );
+      const SizeValueType bandEnd = std::min( y0 + sizeY, ( firstBand + item % bandsPerPlane + 1 ) * bandRows );
+      char * out = static_cast< char * >( buffer ) + planeIndex * sizeY * rowBytes;
+
+      const unsigned int ifd = m_PlaneIFDs[planes[planeIndex]];
+      if( !tiff.SetDirectoryOffset( m_IFDOffsets[ifd] ) )
+        {
+        fail( "cannot read IFD " + std::to_string( ifd ) );
+        return;
+        }
+
+      if( TIFFIsTiled( tiff.File ) )
+        {
+        uint32 tileWidth = 0;
+        uint32 tileLength = 0;
+        TIFFGetField( tiff.File, TIFFTAG_TILEWIDTH, &tileWidth );
+        TIFFGetField( tiff.File, TIFFTAG_TILELENGTH, &tileLength );
+        scratch.resize( TIFFTileSize( tiff.File ) );
+        const SizeValueType tileRowBytes = tileWidth * pixelBytes;
+        for( SizeValueType ty = bandStart / tileLength * tileLength; ty < bandEnd; ty += tileLength )
+          {
+          for( SizeValueType tx = x0 / tileWidth * tileWidth; tx < x0 + sizeX; tx += tileWidth )
+            {
+            const ttile_t tile = TIFFComputeTile( tiff.File, static_cast< uint32 >( tx ), static_cast< uint32 >( ty ), 0, 0 );
+            if( TIFFReadEncodedTile( tiff.File, tile, &scratch[0], static_cast< tmsize_t >( scratch.size() ) ) < 0 )
+              {
+              fail( "cannot decode tile " + std::to_string( tile ) + " of IFD " + std::to_string( ifd ) );
+              return;
+              }
+            const SizeValueType xStart = std::max( x0, tx );
+            const SizeValueType xEnd = std::min( x0 + sizeX, tx + tileWidth );
+            for( SizeValueType y = std::max( bandStart, ty ); y < std::min( bandEnd, ty + tileLength ); ++y )
+              {
+              memcpy( out + ( y - y0 ) * rowBytes + ( xStart - x0 ) * pixelBytes,
+                      &scratch[( y - ty ) * tileRowBytes + ( xStart - tx ) * pixelBytes],
+                      ( xEnd - xStart ) * pixelBytes );
+              }
+            }
+          }
+        }
+      else
+        {
+        uint32 rowsPerStrip = 0;
+        TIFFGetFieldDefaulted( tiff.File, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip );
+        const SizeValueType stripRows = std::max< SizeValueType >( 1, std::min< SizeValueType >( rowsPerStrip, m_Sizes[1] ) );
+        const SizeValueType stripRowBytes = m_Sizes[0] * pixelBytes;
+        scratch.resize( TIFFStripSize( tiff.File ) );
+        for( SizeValueType sy = bandStart / stripRows * stripRows; sy < bandEnd; sy += stripRows )
+          {
+          const tstrip_t strip = TIFFComputeStrip( tiff.File, static_cast< uint32 >( sy ), 0 );
+          if( TIFFReadEncodedStrip( tiff.File, strip, &scratch[0], static_cast< tmsize_t >( scratch.size() ) ) < 0 )
+            {
+            fail( "cannot decode strip " + std::to_string( strip ) + " of IFD " + std::to_string( ifd ) );
+            return;
+            }
+          for( SizeValueType y = std::max( bandStart, sy ); y < std::min( bandEnd, sy + stripRows ); ++y )
+            {
+            memcpy( out + ( y - y0 ) * rowBytes, &scratch[( y - sy ) * stripRowBytes + x0 * pixelBytes], rowBytes );
+            }
+          }
+        }
+      }
+    };
+
+  auto worker = [&]()
+    {
+    std::unique_ptr< TIFFHandle > tiff = this->AcquireHandle();
+    if( !tiff )
+      {
+      fail( "cannot open " + m_FileName );
+      return;
+      }
+    decode( *tiff );
+    this->ReleaseHandle( std::move( tiff ) );
+    };
+
+  const SizeValueType numberOfThreads = std::min< SizeValueType >( std::max( 1u, m_NumberOfWorkUnits ), numberOfItems );
+  std::vector< std::thread > threads;
+  for( SizeValueType i = 1; i < numberOfThreads; ++i )
+    {
+    threads.emplace_back( worker );
+    }
+  worker();
+  for( std::thread & thread : threads )
+    {
+    thread.join();
+    }
+
+  if( !error.empty() )
+    {
+    itkExceptionMacro(<< "Reading " << m_FileName << " natively failed: " << error);
+    }
+}
+
+void
+SCIFIOOMETIFFReader::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "FileName: " << m_FileName << std::endl;
+  os << indent << "Series: " << m_Series << std::endl;
+  os << indent << "SeriesCount: " << m_SeriesCount << std::endl;
+  os << indent << "DimensionOrder: " << m_DimensionOrder << std::endl;
+  os << indent << "NumberOfWorkUnits: " << m_NumberOfWorkUnits << std::endl;
+}
+
+} // end namespace itk
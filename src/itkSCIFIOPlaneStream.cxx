@@ -0,0 +1,257 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkSCIFIOPlaneStream.h"
+#include "itkMetaDataObject.h"
+
+namespace itk
+{
+
+SCIFIOPlaneStream::SCIFIOPlaneStream()
+{
+  m_PlaneAxes[0] = SCIFIOImageIO::ZAxis;
+  m_PlaneAxes[1] = SCIFIOImageIO::CAxis;
+  m_PlaneAxes[2] = SCIFIOImageIO::TAxis;
+}
+
+SCIFIOPlaneStream::~SCIFIOPlaneStream()
+{
+  this->Close();
+}
+
+void
+SCIFIOPlaneStream::Open()
+{
+  this->Close();
+
+  if( m_ImageIO.IsNull() )
+    {
+    m_ImageIO = SCIFIOImageIO::New();
+    }
+  // Planes are read from the file as is.
+  if( m_ImageIO->HasSelection() || m_ImageIO->GetProjection() != SCIFIOImageIO::NoProjection )
+    {
+    itkExceptionMacro(<< "Cannot stream " << m_FileName << " with a selection or projection set on its ImageIO");
+    }
+  m_ImageIO->SetFileName( m_FileName );
+  m_ImageIO->SetSeries( m_Series );
+  m_ImageIO->ReadImageInformation();
+  m_LargestRegion = m_ImageIO->GetXYZTCLargestPossibleRegion();
+
+  // The dimension order lists the axes from the fastest varying, and
+  // always starts with XY.
+  std::string dimensionOrder;
+  if( !ExposeMetaData< std::string >( m_ImageIO->GetMetaDataDictionary(), "DimensionOrder", dimensionOrder )
+      || dimensionOrder.size() != 5 )
+    {
+    dimensionOrder = "XYZCT";
+    }
+  for( unsigned int i = 0; i < 3; ++i )
+    {
+    switch( dimensionOrder[i + 2] )
+      {
+      case 'Z':
+        m_PlaneAxes[i] = SCIFIOImageIO::ZAxis;
+        break;
+      case 'T':
+        m_PlaneAxes[i] = SCIFIOImageIO::TAxis;
+        break;
+      case 'C':
+        m_PlaneAxes[i] = SCIFIOImageIO::CAxis;
+        break;
+      default:
+        itkExceptionMacro(<< "Unexpected dimension order " << dimensionOrder << " in " << m_FileName);
+      }
+    }
+
+  m_NumberOfPlanes = m_LargestRegion.GetSize( SCIFIOImageIO::ZAxis ) * m_LargestRegion.GetSize( SCIFIOImageIO::TAxis )
+                     * m_LargestRegion.GetSize( SCIFIOImageIO::CAxis );
+  m_PlaneBufferSize = m_ImageIO->GetXYZTCRegionBufferSize( this->GetPlaneRegion( 0 ) );
+  m_Buffers.assign( m_NumberOfBuffers, std::vector< char >( m_PlaneBufferSize ) );
+
+  itkDebugMacro(<< "Streaming " << m_NumberOfPlanes << " planes of " << m_PlaneBufferSize << " bytes in "
+                << dimensionOrder << " order through " << m_NumberOfBuffers << " buffers");
+
+  m_Thread = std::thread( &SCIFIOPlaneStream::ReadPlanes, this );
+}
+
+void
+SCIFIOPlaneStream::Close()
+{
+  const bool running = m_Thread.joinable();
+  {
+  std::lock_guard< std::mutex > lock( m_Mutex );
+  m_Stop = true;
+  m_Condition.notify_all();
+  }
+  if( running )
+    {
+    m_Thread.join();
+
+    // Java may still be answering reads that were queued ahead. Restart it
+    // rather than drain them.
+    if( m_PlanesRead < m_NumberOfPlanes )
+      {
+      m_ImageIO->DestroyJavaProcess();
+      }
+    }
+
+  m_Buffers.clear();
+  m_PlanesRead = 0;
+  m_PlanesReleased = 0;
+  m_Started = false;
+  m_Stop = false;
+  m_Exception = nullptr;
+}
+
+bool
+SCIFIOPlaneStream::Next()
+{
+  if( m_Buffers.empty() )
+    {
+    itkExceptionMacro(<< "The stream is not open");
+    }
+
+  std::unique_lock< std::mutex > lock( m_Mutex );
+  SizeValueType next = 0;
+  if( m_Started )
+    {
+    // Hand the buffer of the current plane back to the reading thread.
+    next = m_PlaneNumber + 1;
+    m_PlanesReleased = next;
+    m_Condition.notify_all();
+    }
+  if( next >= m_NumberOfPlanes )
+    {
+    return false;
+    }
+
+  m_Condition.wait( lock, [&]() { return m_PlanesRead > next || m_Exception; } );
+  if( m_PlanesRead <= next )
+    {
+    itkDebugMacro(<< "Reading plane " << next << " of " << m_FileName << " failed");
+    std::rethrow_exception( m_Exception );
+    }
+
+  m_Started = true;
+  m_PlaneNumber = next;
+  const ImageIORegion region = this->GetPlaneRegion( next );
+  m_Z = region.GetIndex( SCIFIOImageIO::ZAxis );
+  m_C = region.GetIndex( SCIFIOImageIO::CAxis );
+  m_T = region.GetIndex( SCIFIOImageIO::TAxis );
+  return true;
+}
+
+const void *
+SCIFIOPlaneStream::GetPlane() const
+{
+  if( !m_Started )
+    {
+    itkExceptionMacro(<< "There is no current plane; call Next() first");
+    }
+  return &m_Buffers[m_PlaneNumber % m_Buffers.size()][0];
+}
+
+ImageIORegion
+SCIFIOPlaneStream::GetPlaneRegion(SizeValueType plane) const
+{
+  ImageIORegion region = m_LargestRegion;
+  for( unsigned int axis : m_PlaneAxes )
+    {
+    const SizeValueType size = m_LargestRegion.GetSize( axis );
+    region.SetIndex( axis, plane % size );
+    region.SetSize( axis, 1 );
+    plane /= size;
+    }
+  return region;
+}
+
+void
+SCIFIOPlaneStream::ReadPlanes()
+{
+  const SizeValueType numberOfBuffers = m_Buffers.size();
+  try
+    {
+    // Planes too large for a single transfer are read in strips, and planes
+    // read without pipes directly, one at a time; others have a read queued
+    // for each free buffer, so that Java never waits for the consumer to ask.
+    const bool oneAtATime = m_PlaneBufferSize > m_ImageIO->GetMaximumTransferSize() || m_ImageIO->ReadsInProcess();
+    if( !oneAtATime )
+      {
+      m_ImageIO->CreateJavaProcess();
+      if( m_ImageIO->m_SeriesPending )
+        {
+        m_ImageIO->SendSeries();
+        }
+      }
+
+    SizeValueType sent = 0;
+    for( SizeValueType plane = 0; plane < m_NumberOfPlanes; ++plane )
+      {
+      SizeValueType released;
+      {
+      std::unique_lock< std::mutex > lock( m_Mutex );
+      m_Condition.wait( lock, [&]() { return m_Stop || plane < m_PlanesReleased + numberOfBuffers; } );
+      if( m_Stop )
+        {
+        return;
+        }
+      released = m_PlanesReleased;
+      }
+
+      char * buffer = &m_Buffers[plane % numberOfBuffers][0];
+      if( oneAtATime )
+        {
+        m_ImageIO->ReadXYZTCRegion( buffer, this->GetPlaneRegion( plane ) );
+        }
+      else
+        {
+        for( ; sent < m_NumberOfPlanes && sent < released + numberOfBuffers; ++sent )
+          {
+          m_ImageIO->SendReadCommand( this->GetPlaneRegion( sent ) );
+          }
+        m_ImageIO->ReceiveData( buffer, m_PlaneBufferSize, plane + 1 < sent );
+        }
+
+      std::lock_guard< std::mutex > lock( m_Mutex );
+      m_PlanesRead = plane + 1;
+      m_Condition.notify_all();
+      }
+    }
+  catch( ... )
+    {
+    // Anything escaping the thread would terminate the process.
+    std::lock_guard< std::mutex > lock( m_Mutex );
+    m_Exception = std::current_exception();
+    m_Condition.notify_all();
+    }
+}
+
+void
+SCIFIOPlaneStream::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "FileName: " << m_FileName << std::endl;
+  os << indent << "Series: " << m_Series << std::endl;
+  os << indent << "NumberOfBuffers: " << m_NumberOfBuffers << std::endl;
+  os << indent << "NumberOfPlanes: " << m_NumberOfPlanes << std::endl;
+  os << indent << "PlaneBufferSize: " << m_PlaneBufferSize << std::endl;
+  os << indent << "PlaneNumber: " << m_PlaneNumber << std::endl;
+}
+
+} // end namespace itk
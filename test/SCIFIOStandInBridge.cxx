@@ -0,0 +1,361 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+/**
+ * A native stand-in for the SCIFIO ITK bridge (SCIFIOITKBridge waitForInput)
+ * that speaks its protocol on stdin and stdout, but serves synthetic data
+ * instead of decoding files, and discards written pixels. Run in place of
+ * Java by setting SCIFIO_BRIDGE_COMMAND, it takes Java and decoding out of
+ * the picture when profiling SCIFIOImageIO.
+ *
+ * Image information is taken from the file name, as for .fake files: for
+ * example "image&sizeX=512&sizeY=256&sizeZ=10&pixelType=uint16.fake".
+ * Asking for the information of a file with "failInfo=true" in its name
+ * fails as the bridge does when Bio-Formats throws.
+ *
+ * Options:
+ *   --keep-writes     write the pixels received, planes and sub-resolutions
+ *                     in the order sent, to the file being written, instead
+ *                     of discarding them
+ *   --no-resolutions  ignore the resolutions field of writes, as
+ *                     scifio-itk-bridge 1.2.1 does
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+  bool keepWrites = false;
+  bool acceptResolutions = true;
+
+  struct ImageInfo
+  {
+    unsigned long long sizes[5] = { 512, 512, 1, 1, 1 };
+    int                pixelType = 1;
+    int                bytesPerPixel = 1;
+    int                seriesCount = 1;
+    bool               failInfo = false;
+  };
+
+  ImageInfo parseFileName( const std::string & fileName )
+  {
+    ImageInfo info;
+    const char * sizeKeys[] = { "sizeX", "sizeY", "sizeZ", "sizeT", "sizeC" };
+
+    // SCIFIO pixel types, in the bridge's numbering, and their sizes.
+    const char * pixelTypes[] = { "int8", "uint8", "int16", "uint16", "int32", "uint32", "float", "double" };
+    const int pixelSizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+    std::string name = fileName.substr( fileName.find_last_of( "/\\" ) + 1 );
+    name = name.substr( 0, name.rfind( '.' ) );
+    std::istringstream in( name );
+    std::string parameter;
+    while( std::getline( in, parameter, '&' ) )
+      {
+      const size_t equals = parameter.find( '=' );
+      if( equals == std::string::npos )
+        {
+        continue;
+        }
+      const std::string key = parameter.substr( 0, equals );
+      const std::string value = parameter.substr( equals + 1 );
+      for( int i = 0; i < 5; ++i )
+        {
+        if( key == sizeKeys[i] )
+          {
+          info.sizes[i] = std::stoull( value );
+          }
+        }
+      for( int i = 0; i < 8; ++i )
+        {
+        if( key == "pixelType" && value == pixelTypes[i] )
+          {
+          info.pixelType = i;
+          info.bytesPerPixel = pixelSizes[i];
+          }
+        }
+      if( key == "series" )
+        {
+        info.seriesCount = std::stoi( value );
+        }
+      if( key == "failInfo" )
+        {
+        info.failInfo = value == "true";
+        }
+      }
+    return info;
+  }
+
+  void reply( const std::string & text )
+  {
+    fwrite( text.data(), 1, text.size(), stdout );
+    fputs( "\n\n", stdout );
+    fflush( stdout );
+  }
+
+  bool readExactly( std::vector< char > & buffer, size_t count )
+  {
+    buffer.resize( count );
+    return count == 0 || fread( &buffer[0], 1, count, stdin ) == count;
+  }
+
+  bool readLine( std::string & line )
+  {
+    line.clear();
+    int c;
+    while( ( c = fgetc( stdin ) ) != EOF && c != '\n' )
+      {
+      line += static_cast< char >( c );
+      }
+    return c != EOF || !line.empty();
+  }
+
+  void info( const ImageInfo & image )
+  {
+    const char * axes = "XYZTC";
+    std::ostringstream out;
+    for( int i = 0; i < 5; ++i )
+      {
+      out << "Size" << axes[i] << "\n" << image.sizes[i] << "\n";
+      out << "PixelsPhysicalSize" << axes[i] << "\n" << 1.0 << "\n";
+      }
+    out << "PixelType\n" << image.pixelType << "\n";
+    out << "RGBChannelCount\n1\n";
+    out << "Interleaved\nfalse\n";
+    out << "LittleEndian\ntrue\n";
+    out << "DimensionOrder\nXYZCT\n";
+    out << "UseLUT\nfalse\n";
+    out << "SeriesCount\n" << image.seriesCount;
+    reply( out.str() );
+  }
+
+  // Serves a gradient along X and Y, one row at a time.
+  void read( const ImageInfo & image, const std::vector< unsigned long long > & region )
+  {
+    const unsigned long long rowBytes = region[1] * image.bytesPerPixel;
+    const unsigned long long rows = region[3] * region[5] * region[7] * region[9];
+    std::vector< char > row( rowBytes );
+    for( unsigned long long r = 0; r < rows; ++r )
+      {
+      const unsigned long long y = region[2] + r % region[3];
+      for( unsigned long long i = 0; i < rowBytes; ++i )
+        {
+        row[i] = static_cast< char >( region[0] + i / image.bytesPerPixel + y );
+        }
+      fwrite( row.data(), 1, row.size(), stdout );
+      }
+    fflush( stdout );
+  }
+
+  // Consumes a plane in chunks, acknowledging them as the bridge does, and
+  // keeps them in out, if given.
+  bool readPlane( unsigned long long bytesPerPlane, const std::string & written, std::ostream * out )
+  {
+    const unsigned long long chunk = 10000;
+    std::vector< char > buffer;
+    for( unsigned long long done = 0; done < bytesPerPlane; )
+      {
+      const unsigned long long count = bytesPerPlane - done < chunk ? bytesPerPlane - done : chunk;
+      if( !readExactly( buffer, count ) )
+        {
+        return false;
+        }
+      done += count;
+      if( out )
+        {
+        out->write( buffer.data(), buffer.size() );
+        }
+      reply( "Bytes read: " + std::to_string( done ) );
+      }
+    if( !readExactly( buffer, 2 ) )
+      {
+      return false;
+      }
+    reply( written );
+    return true;
+  }
+
+  // Consumes the planes of a write, acknowledging them as the bridge does.
+  // The reply holds the bytes per plane and the number of planes, as from
+  // the bridge. Sub-resolutions requested with a resolutions field are
+  // accepted, unless --no-resolutions is given, with a "resolutions" line
+  // in the reply, and expected after each plane, largest first.
+  bool write( const std::vector< std::string > & fields )
+  {
+    // fields: write, file, byte order, dimension, 5 sizes, 5 spacings,
+    // pixel type, channel count, ...
+    if( fields.size() < 16 )
+      {
+      return false;
+      }
+    const int pixelSizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+    const int pixelType = std::stoi( fields[14] );
+    const unsigned long long bytesPerPixel = std::stoull( fields[15] )
+      * pixelSizes[pixelType < 0 || pixelType > 7 ? 7 : pixelType];
+    unsigned long long sizeX = std::stoull( fields[4] );
+    unsigned long long sizeY = std::stoull( fields[5] );
+    const unsigned long long planes = std::stoull( fields[6] ) * std::stoull( fields[7] ) * std::stoull( fields[8] );
+
+    std::vector< unsigned long long > levelBytes( 1, sizeX * sizeY * bytesPerPixel );
+    for( size_t i = 16; acceptResolutions && i + 2 < fields.size(); ++i )
+      {
+      if( fields[i] == "resolutions" )
+        {
+        const unsigned long long resolutions = std::stoull( fields[i + 1] );
+        const unsigned long long factor = std::stoull( fields[i + 2] );
+        for( unsigned long long level = 1; level < resolutions; ++level )
+          {
+          sizeX = ( sizeX + factor - 1 ) / factor;
+          sizeY = ( sizeY + factor - 1 ) / factor;
+          levelBytes.push_back( sizeX * sizeY * bytesPerPixel );
+          }
+        }
+      }
+    reply( std::to_string( levelBytes[0] ) + "\n" + std::to_string( planes )
+           + ( levelBytes.size() > 1 ? "\nresolutions\t" + std::to_string( levelBytes.size() ) : "" ) );
+
+    std::ofstream kept;
+    if( keepWrites )
+      {
+      kept.open( fields[1].c_str(), std::ios::binary );
+      }
+
+    for( unsigned long long plane = 0; plane < planes; ++plane )
+      {
+      for( size_t level = 0; level < levelBytes.size(); ++level )
+        {
+        const std::string written = level == 0 ? " written" : " level " + std::to_string( level ) + " written";
+        if( !readPlane( levelBytes[level], "Plane " + std::to_string( plane ) + written,
+                        keepWrites ? &kept : nullptr ) )
+          {
+          return false;
+          }
+        }
+      }
+    std::vector< char > buffer;
+    if( !readExactly( buffer, 2 ) )
+      {
+      return false;
+      }
+    reply( "Image written" );
+    return true;
+  }
+}
+
+int main( int argc, char * argv[] )
+{
+  for( int i = 1; i < argc; ++i )
+    {
+    if( std::strcmp( argv[i], "--keep-writes" ) == 0 )
+      {
+      keepWrites = true;
+      }
+    else if( std::strcmp( argv[i], "--no-resolutions" ) == 0 )
+      {
+      acceptResolutions = false;
+      }
+    else
+      {
+      std::cerr << "Usage: " << argv[0] << " [--keep-writes] [--no-resolutions]" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+#ifdef _WIN32
+  _setmode( _fileno( stdin ), _O_BINARY );
+  _setmode( _fileno( stdout ), _O_BINARY );
+#endif
+
+  ImageInfo image;
+  std::string line;
+  while( readLine( line ) )
+    {
+    std::vector< std::string > fields;
+    std::istringstream in( line );
+    std::string field;
+    while( std::getline( in, field, '\t' ) )
+      {
+      fields.push_back( field );
+      }
+    if( fields.empty() )
+      {
+      continue;
+      }
+
+    const std::string & command = fields[0];
+    if( ( command == "canRead" || command == "canWrite" ) && fields.size() > 1 )
+      {
+      reply( "true" );
+      }
+    else if( command == "info" && fields.size() > 1 )
+      {
+      image = parseFileName( fields[1] );
+      if( image.failInfo )
+        {
+        std::cerr << "Caught exception: cannot read " << fields[1] << std::endl;
+        continue;
+        }
+      info( image );
+      }
+    else if( command == "series" )
+      {
+      reply( "true" );
+      }
+    else if( command == "seriesCount" )
+      {
+      reply( std::to_string( image.seriesCount ) );
+      }
+    else if( command == "read" && fields.size() >= 12 )
+      {
+      image = parseFileName( fields[1] );
+      std::vector< unsigned long long > region;
+      for( size_t i = 2; i < 12; ++i )
+        {
+        region.push_back( std::stoull( fields[i] ) );
+        }
+      read( image, region );
+      }
+    else if( command == "write" )
+      {
+      if( !write( fields ) )
+        {
+        std::cerr << "Command failure: malformed write" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    else
+      {
+      std::cerr << "Command failure: unknown command " << command << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOChunkCache.h"
+#include "itkSCIFIOImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImage.h"
+#include "itksys/SystemTools.hxx"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Reads a fake image through a chunk cache, then again through another cache
+ * on the same directory, as a later run would, and checks that the second
+ * read is served from the cache, without data from Java, and matches the
+ * first. Also reads part of a plane from the cache, and checks the eviction
+ * of the least recently used chunks and the keys of changed files.
+ */
+int itkSCIFIOChunkCacheTest( int argc, char * argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " directory\n";
+    return EXIT_FAILURE;
+    }
+  const std::string directory = argv[1];
+  const std::string chunkDirectory = directory + "/chunks";
+  const std::string traceFileName = directory + "/trace.txt";
+
+  using ImageType = itk::Image< unsigned short, 3 >;
+  using ReaderType = itk::ImageFileReader< ImageType >;
+
+  try
+    {
+    itksys::SystemTools::RemoveADirectory( directory );
+    itksys::SystemTools::MakeDirectory( directory );
+
+    // Only files on disk have an identity to cache their planes by.
+    const std::string fileName = directory + "/scifioCache&sizeX=64&sizeY=48&sizeZ=6&pixelType=uint16.fake";
+    std::ofstream( fileName.c_str() ).close();
+
+    itk::SCIFIOChunkCache::Pointer firstCache = itk::SCIFIOChunkCache::New();
+    firstCache->SetDirectory( chunkDirectory );
+    itk::SCIFIOImageIO::Pointer firstIO = itk::SCIFIOImageIO::New();
+    firstIO->SetChunkCache( firstCache );
+    ReaderType::Pointer first = ReaderType::New();
+    first->SetImageIO( firstIO );
+    first->SetFileName( fileName );
+    first->Update();
+    assertEquals( "first hits", 0, firstCache->GetNumberOfHits() );
+    assertEquals( "first misses", 6, firstCache->GetNumberOfMisses() );
+
+    itk::SCIFIOChunkCache::Pointer cache = itk::SCIFIOChunkCache::New();
+    cache->SetDirectory( chunkDirectory );
+    itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+    io->SetChunkCache( cache );
+    io->SetTraceFileName( traceFileName );
+    ReaderType::Pointer second = ReaderType::New();
+    second->SetImageIO( io );
+    second->SetFileName( fileName );
+    second->Update();
+    io->SetTraceFileName( "" );
+    assertEquals( "second hits", 6, cache->GetNumberOfHits() );
+    assertEquals( "second misses", 0, cache->GetNumberOfMisses() );
+
+    unsigned int dataReplies = 0;
+    std::ifstream trace( traceFileName.c_str() );
+    std::string line;
+    while( std::getline( trace, line ) )
+      {
+      if( line[line.find( '\t' ) + 1] == 'd' )
+        {
+        ++dataReplies;
+        }
+      }
+    assertEquals( "data replies from Java", 0, dataReplies );
+
+    const ImageType * expectedImage = first->GetOutput();
+    itk::ImageRegionConstIterator< ImageType > expected( expectedImage, expectedImage->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< ImageType > actual( second->GetOutput(),
+                                                       second->GetOutput()->GetLargestPossibleRegion() );
+    for( ; !expected.IsAtEnd(); ++expected, ++actual )
+      {
+      assertEquals( "cached pixel", expected.Get(), actual.Get() );
+      }
+
+    // Part of two planes.
+    itk::ImageIORegion region = io->GetXYZTCLargestPossibleRegion();
+    region.SetIndex( 0, 5 );
+    region.SetSize( 0, 30 );
+    region.SetIndex( 1, 7 );
+    region.SetSize( 1, 20 );
+    region.SetIndex( 2, 3 );
+    region.SetSize( 2, 2 );
+    std::vector< unsigned short > part( 30 * 20 * 2 );
+    io->ReadXYZTCRegion( &part[0], region );
+    for( unsigned int i = 0; i < part.size(); ++i )
+      {
+      ImageType::IndexType index;
+      index[0] = 5 + i % 30;
+      index[1] = 7 + i / 30 % 20;
+      index[2] = 3 + i / 600;
+      assertEquals( "pixel of a part", expectedImage->GetPixel( index ), part[i] );
+      }
+    assertEquals( "hits with the part", 8, cache->GetNumberOfHits() );
+
+    // With room for three chunks, the least recently used go first.
+    itk::SCIFIOChunkCache::Pointer small = itk::SCIFIOChunkCache::New();
+    small->SetDirectory( directory + "/small" );
+    small->SetMaximumSize( 3 * ( 4096 + 1000 ) + 500 );
+    const std::vector< char > chunk( 1000, 42 );
+    const char * keys[] = { "a", "b", "c" };
+    for( const char * key : keys )
+      {
+      small->Insert( key, &chunk[0], chunk.size() );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+      }
+    if( !small->Find( "a" ) )
+      {
+      std::cerr << "[ERROR] chunk a is not cached" << std::endl;
+      return EXIT_FAILURE;
+      }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    small->Insert( "d", &chunk[0], chunk.size() );
+    const itk::SCIFIOChunkCache::MappedChunkPointer found = small->Find( "d" );
+    if( !small->Find( "a" ) || !found || small->Find( "b" ) )
+      {
+      std::cerr << "[ERROR] chunk b should have been evicted, and chunks a and d kept" << std::endl;
+      return EXIT_FAILURE;
+      }
+    assertEquals( "chunk size", chunk.size(), found->GetSize() );
+    assertEquals( "chunk byte", 42, int( found->GetData()[999] ) );
+
+    // Changing a file changes the keys of its planes.
+    const std::string key = itk::SCIFIOChunkCache::MakeKey( fileName, 0, 1 );
+    std::ofstream( fileName.c_str(), std::ios::app ) << "changed";
+    const bool keyChanged = key != itk::SCIFIOChunkCache::MakeKey( fileName, 0, 1 );
+    assertEquals( "key of a changed file changed", true, keyChanged );
+    const std::string sameLengthKey = itk::SCIFIOChunkCache::MakeKey( fileName, 0, 1 );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    std::fstream rewritten( fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+    rewritten.put( 'x' );
+    rewritten.close();
+    const bool sameLengthKeyChanged = sameLengthKey != itk::SCIFIOChunkCache::MakeKey( fileName, 0, 1 );
+    assertEquals( "key of a file rewritten at the same length changed", true, sameLengthKeyChanged );
+    const std::string patternKey = itk::SCIFIOChunkCache::MakeKey( directory + "/img_z<0-1>.tif", 0, 0 );
+    assertEquals( "key of a file pattern", "", patternKey );
+    const std::string missingKey = itk::SCIFIOChunkCache::MakeKey( directory + "/missing", 0, 0 );
+    assertEquals( "key of a missing file", "", missingKey );
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
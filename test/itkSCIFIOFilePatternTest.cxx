@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImage.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Writes a plane per Z and T to files named <prefix>_z<z>_t<t>.tif, finds
+ * their file pattern, and reads it back as a single 4-D image, checking the
+ * value of every plane. The read is traced, and the trace, which must name
+ * the pattern rather than the pattern file, replayed.
+ */
+int itkSCIFIOFilePatternTest( int argc, char * argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputPrefix\n";
+    return EXIT_FAILURE;
+    }
+  const std::string prefix = argv[1];
+  const unsigned int sizeZ = 3;
+  const unsigned int sizeT = 2;
+
+  using PixelType = unsigned char;
+  using PlaneType = itk::Image< PixelType, 2 >;
+  using ImageType = itk::Image< PixelType, 4 >;
+
+  // Identifies a plane by its value.
+  const auto planeValue = []( unsigned int z, unsigned int t ) { return static_cast< PixelType >( 10 * t + z + 1 ); };
+
+  try
+    {
+    std::vector< std::string > fileNames;
+    for( unsigned int t = 0; t < sizeT; ++t )
+      {
+      for( unsigned int z = 0; z < sizeZ; ++z )
+        {
+        PlaneType::Pointer plane = PlaneType::New();
+        PlaneType::SizeType size = { { 32, 16 } };
+        plane->SetRegions( size );
+        plane->Allocate();
+        plane->FillBuffer( planeValue( z, t ) );
+
+        std::ostringstream fileName;
+        fileName << prefix << "_z00" << z << "_t00" << t << ".tif";
+        fileNames.push_back( fileName.str() );
+
+        using WriterType = itk::ImageFileWriter< PlaneType >;
+        WriterType::Pointer writer = WriterType::New();
+        writer->SetImageIO( itk::SCIFIOImageIO::New() );
+        writer->SetInput( plane );
+        writer->SetFileName( fileName.str() );
+        writer->Update();
+        }
+      }
+
+    const std::string pattern = itk::SCIFIOImageIO::FindFilePattern( fileNames );
+    assertEquals( "pattern", prefix + "_z<000-002>_t<000-001>.tif", pattern );
+    if( !itk::SCIFIOImageIO::IsFilePattern( pattern ) || itk::SCIFIOImageIO::IsFilePattern( fileNames[0] ) )
+      {
+      std::cerr << "[ERROR] file patterns are not told apart from file names" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    const std::string traceFileName = prefix + ".trace";
+    itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+    io->SetTraceFileName( traceFileName );
+    if( !io->CanReadFile( pattern.c_str() ) )
+      {
+      std::cerr << "[ERROR] cannot read " << pattern << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    using ReaderType = itk::ImageFileReader< ImageType >;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetImageIO( io );
+    reader->SetFileName( pattern );
+    reader->Update();
+    ImageType::Pointer image = reader->GetOutput();
+
+    const ImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+    assertEquals( "sizeX", 32, size[0] );
+    assertEquals( "sizeY", 16, size[1] );
+    assertEquals( "sizeZ", sizeZ, size[2] );
+    assertEquals( "sizeT", sizeT, size[3] );
+
+    itk::ImageRegionIterator< ImageType > it( image, image->GetLargestPossibleRegion() );
+    for( ; !it.IsAtEnd(); ++it )
+      {
+      const ImageType::IndexType index = it.GetIndex();
+      const int expected = planeValue( index[2], index[3] );
+      assertEquals( "pixel value", expected, static_cast< int >( it.Get() ) );
+      }
+
+    io->SetTraceFileName( "" );
+    std::ifstream trace( traceFileName.c_str() );
+    std::string line;
+    bool patternTraced = false;
+    while( std::getline( trace, line ) )
+      {
+      patternTraced = patternTraced || line.find( pattern ) != std::string::npos;
+      if( line.find( ".pattern" ) != std::string::npos )
+        {
+        std::cerr << "[ERROR] a pattern file was traced: " << line << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    assertEquals( "pattern traced", true, patternTraced );
+    itk::SCIFIOImageIO::Pointer replayIO = itk::SCIFIOImageIO::New();
+    std::ostringstream report;
+    if( replayIO->ReplayTrace( traceFileName, report ) == 0 )
+      {
+      std::cerr << "[ERROR] nothing was replayed" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    // Lists that are not a complete grid have no pattern.
+    fileNames.pop_back();
+    bool caught = false;
+    try
+      {
+      itk::SCIFIOImageIO::FindFilePattern( fileNames );
+      }
+    catch( itk::ExceptionObject & )
+      {
+      caught = true;
+      }
+    if( !caught )
+      {
+      std::cerr << "[ERROR] an incomplete list of files was given a pattern" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Benchmarks CanReadFile probes of files of several formats, with all file
+ * names accepted and with only the given suffixes (and fake), and checks
+ * that files with other suffixes are turned down, and let through once
+ * their suffix is allowed. The bridge sets up every format either way; only
+ * the probes of files with other suffixes are saved.
+ *
+ *   SCIFIOTestDriver itkSCIFIOFileSuffixesTest [probes [suffix ...]]
+ */
+int itkSCIFIOFileSuffixesTest( int argc, char * argv[] )
+{
+  const unsigned int probes = argc > 1 ? atoi( argv[1] ) : 20;
+  std::vector< std::string > suffixes;
+  for( int i = 2; i < argc; ++i )
+    {
+    suffixes.push_back( argv[i] );
+    }
+  // The probes and checks read fake files.
+  if( std::find( suffixes.begin(), suffixes.end(), "fake" ) == suffixes.end() )
+    {
+    suffixes.push_back( "fake" );
+    }
+
+  const std::string fakeFileName = "scifioSuffixes&sizeX=16&sizeY=16.fake";
+  const char * probedFileNames[] = { "scifioSuffixes.czi", "scifioSuffixes.nd2", "scifioSuffixes.lif",
+                                     "scifioSuffixes.png", "scifioSuffixes&sizeX=8&sizeY=8.fake" };
+
+  try
+    {
+    std::cout << std::left << std::setw( 16 ) << "Suffixes" << std::right
+              << std::setw( 16 ) << "canRead (ms)" << std::endl;
+
+    for( const bool allowList : { false, true } )
+      {
+      itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+      io->SetAllowedFileSuffixes( allowList ? suffixes : std::vector< std::string >() );
+
+      // Starting the bridge is left out of the timings.
+      const bool canReadFake = io->CanReadFile( fakeFileName.c_str() );
+      assertEquals( "can read a fake file", true, canReadFake );
+
+      itk::TimeProbe probe;
+      probe.Start();
+      for( unsigned int i = 0; i < probes; ++i )
+        {
+        for( const char * fileName : probedFileNames )
+          {
+          io->CanReadFile( fileName );
+          }
+        }
+      probe.Stop();
+
+      const unsigned int count = probes * sizeof( probedFileNames ) / sizeof( probedFileNames[0] );
+      std::cout << std::left << std::setw( 16 ) << ( allowList ? "allowed only" : "all" ) << std::right
+                << std::setw( 16 ) << 1000.0 * probe.GetTotal() / count << std::endl;
+
+      if( allowList )
+        {
+        const bool canReadOther = io->CanReadFile( "scifioSuffixes.xyz" );
+        assertEquals( "can read another suffix", false, canReadOther );
+
+        std::vector< std::string > moreSuffixes = suffixes;
+        moreSuffixes.push_back( "xyz" );
+        io->SetAllowedFileSuffixes( moreSuffixes );
+        assertEquals( "suffixes", moreSuffixes.size(), io->GetAllowedFileSuffixes().size() );
+        const bool allowed = io->HasAllowedFileSuffix( "scifioSuffixes.XYZ" );
+        assertEquals( "suffix allowed, in any case", true, allowed );
+        const bool canReadAfterChange = io->CanReadFile( fakeFileName.c_str() );
+        assertEquals( "can read a fake file after changing the suffixes", true, canReadAfterChange );
+        }
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkTimeProbe.h"
+
+#include <cstring>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Reads a fake RGB image through the embedded JVM and through the Java
+ * subprocess, and checks that the image information and the pixels of the
+ * whole image and of a sub-region agree. Reports the read times of both.
+ * An optional maximum transfer size makes both read in strips.
+ */
+int itkSCIFIOJNITest( int argc, char * argv[] )
+{
+  const char * fileName = "scifioJNI&sizeX=256&sizeY=128&sizeZ=4&sizeT=3&sizeC=6&rgb=3&pixelType=uint16.fake";
+
+  if( !itk::SCIFIOJNIReader::IsAvailable() )
+    {
+    std::cerr << "[ERROR] SCIFIO was built without JNI support" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  try
+    {
+    itk::SCIFIOImageIO::Pointer jni = itk::SCIFIOImageIO::New();
+    jni->SetBackend( itk::SCIFIOImageIO::JNIBackend );
+    itk::SCIFIOImageIO::Pointer subprocess = itk::SCIFIOImageIO::New();
+    subprocess->SetBackend( itk::SCIFIOImageIO::SubprocessBackend );
+    if( argc > 1 )
+      {
+      jni->SetMaximumTransferSize( atoi( argv[1] ) );
+      subprocess->SetMaximumTransferSize( atoi( argv[1] ) );
+      }
+
+    if( !jni->CanReadFile( fileName ) )
+      {
+      std::cerr << "[ERROR] " << fileName << " cannot be read through JNI" << std::endl;
+      return EXIT_FAILURE;
+      }
+    jni->SetFileName( fileName );
+    jni->ReadImageInformation();
+    subprocess->SetFileName( fileName );
+    subprocess->ReadImageInformation();
+
+    assertEquals( "series count", subprocess->GetSeriesCount(), jni->GetSeriesCount() );
+    assertEquals( "component type", subprocess->GetComponentType(), jni->GetComponentType() );
+    assertEquals( "number of components", subprocess->GetNumberOfComponents(), jni->GetNumberOfComponents() );
+    assertEquals( "byte order", subprocess->GetByteOrder(), jni->GetByteOrder() );
+    assertEquals( "largest region", subprocess->GetXYZTCLargestPossibleRegion(), jni->GetXYZTCLargestPossibleRegion() );
+
+    itk::ImageIORegion subRegion = jni->GetXYZTCLargestPossibleRegion();
+    const itk::SizeValueType subSizes[] = { 101, 67, 3, 2, 2 };
+    for( unsigned int i = 0; i < 5; ++i )
+      {
+      subRegion.SetIndex( i, subRegion.GetSize( i ) - subSizes[i] );
+      subRegion.SetSize( i, subSizes[i] );
+      }
+
+    const itk::ImageIORegion regions[] = { jni->GetXYZTCLargestPossibleRegion(), subRegion };
+    for( const itk::ImageIORegion & region : regions )
+      {
+      const itk::SizeValueType size = jni->GetXYZTCRegionBufferSize( region );
+      std::vector< char > jniPixels( size );
+      std::vector< char > subprocessPixels( size );
+
+      itk::TimeProbe jniTime;
+      jniTime.Start();
+      jni->ReadXYZTCRegion( &jniPixels[0], region );
+      jniTime.Stop();
+
+      itk::TimeProbe subprocessTime;
+      subprocessTime.Start();
+      subprocess->ReadXYZTCRegion( &subprocessPixels[0], region );
+      subprocessTime.Stop();
+
+      std::cout << "Read " << size << " bytes: JNI " << jniTime.GetTotal()
+                << " s, subprocess " << subprocessTime.GetTotal() << " s" << std::endl;
+      if( memcmp( &jniPixels[0], &subprocessPixels[0], size ) != 0 )
+        {
+        std::cerr << "[ERROR] JNI and subprocess reads of " << region << " differ" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
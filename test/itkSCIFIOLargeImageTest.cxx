@@ -0,0 +1,143 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImage.h"
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  using PixelType = unsigned short;
+  using ImageType = itk::Image< PixelType, 2 >;
+
+  // Reads one row of a file with a fresh SCIFIOImageIO, in a single transfer.
+  std::vector< PixelType > readRow( const std::string & fileName, itk::SizeValueType y )
+  {
+    itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+    io->SetFileName( fileName );
+    io->ReadImageInformation();
+
+    itk::ImageIORegion row = io->GetXYZTCLargestPossibleRegion();
+    row.SetIndex( 1, y );
+    row.SetSize( 1, 1 );
+    std::vector< PixelType > pixels( row.GetSize( 0 ) );
+    io->ReadXYZTCRegion( &pixels[0], row );
+    return pixels;
+  }
+
+  bool compareRow( const ImageType * image, const std::vector< PixelType > & row, itk::SizeValueType y )
+  {
+    ImageType::IndexType index;
+    index[1] = y;
+    for( itk::SizeValueType x = 0; x < row.size(); ++x )
+      {
+      index[0] = x;
+      if( image->GetPixel( index ) != row[x] )
+        {
+        std::cerr << "[ERROR] pixel (" << x << ", " << y << ") is " << image->GetPixel( index )
+                  << ", expected " << row[x] << std::endl;
+        return false;
+        }
+      }
+    return true;
+  }
+}
+
+int itkSCIFIOLargeImageTest( int argc, char * argv[] )
+{
+  if( argc < 5 )
+    {
+    std::cerr << "Usage: " << argv[0] << " output sizeX sizeY maximumTransferSize\n";
+    return EXIT_FAILURE;
+    }
+  const std::string outputFileName = argv[1];
+  const itk::SizeValueType sizeX = std::stoull( argv[2] );
+  const itk::SizeValueType sizeY = std::stoull( argv[3] );
+  const itk::SizeValueType maximumTransferSize = std::stoull( argv[4] );
+
+  std::ostringstream id;
+  id << "scifioLarge&sizeX=" << sizeX << "&sizeY=" << sizeY << "&pixelType=uint16.fake";
+
+  try
+    {
+    // Read the whole plane, in strips if it exceeds the transfer size.
+    itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+    io->SetMaximumTransferSize( maximumTransferSize );
+
+    using ReaderType = itk::ImageFileReader< ImageType >;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetImageIO( io );
+    reader->SetFileName( id.str() );
+    reader->Update();
+    ImageType::Pointer image = reader->GetOutput();
+
+    std::cout << "Read " << sizeX << " x " << sizeY << " plane ("
+              << sizeX * sizeY * sizeof( PixelType ) << " bytes)" << std::endl;
+
+    // The first and last rows, which lie beyond any 32-bit offset for large
+    // planes, must match what a direct read of them returns.
+    if( !compareRow( image, readRow( id.str(), 0 ), 0 )
+        || !compareRow( image, readRow( id.str(), sizeY - 1 ), sizeY - 1 ) )
+      {
+      return EXIT_FAILURE;
+      }
+
+    // Write the plane back out, and check the rows again. The bridge only
+    // writes whole planes, so larger planes than it takes must be refused
+    // before anything is sent.
+    using WriterType = itk::ImageFileWriter< ImageType >;
+    WriterType::Pointer writer = WriterType::New();
+    itk::SCIFIOImageIO::Pointer ioOut = itk::SCIFIOImageIO::New();
+    writer->SetImageIO( ioOut );
+    writer->SetInput( image );
+    writer->SetFileName( outputFileName );
+    if( sizeX * sizeY * sizeof( PixelType ) > ioOut->GetMaximumTransferSize() )
+      {
+      try
+        {
+        writer->Update();
+        }
+      catch( itk::ExceptionObject & e )
+        {
+        std::cout << "Writing the plane failed as expected: " << e.GetDescription() << std::endl;
+        return EXIT_SUCCESS;
+        }
+      std::cerr << "[ERROR] a plane larger than the bridge takes was written" << std::endl;
+      return EXIT_FAILURE;
+      }
+    writer->Update();
+
+    std::cout << "Wrote " << outputFileName << std::endl;
+
+    if( !compareRow( image, readRow( outputFileName, 0 ), 0 )
+        || !compareRow( image, readRow( outputFileName, sizeY - 1 ), sizeY - 1 ) )
+      {
+      return EXIT_FAILURE;
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
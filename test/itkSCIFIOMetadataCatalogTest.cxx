@@ -0,0 +1,131 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkSCIFIOMetadataCatalog.h"
+
+#include "itksys/SystemTools.hxx"
+
+#include <fstream>
+#include <string>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+int itkSCIFIOMetadataCatalogTest( int argc, char * argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " outputDirectory [numberOfWorkers [failing]]\n";
+    return EXIT_FAILURE;
+    }
+
+  // With failing, one more file makes the bridge fail, as the
+  // SCIFIOStandInBridge does for failInfo=true.
+  const std::string directory = std::string( argv[1] ) + ( argc > 3 ? "/scifioFailingCatalog" : "/scifioCatalog" );
+  const std::string catalogFileName = directory + ".txt";
+  const unsigned int numberOfWorkers = argc > 2 ? atoi( argv[2] ) : 2;
+  const bool failing = argc > 3 && atoi( argv[3] ) != 0;
+  const std::string failingName = "e&sizeX=8&sizeY=8&failInfo=true.fake";
+
+  // Populate a directory tree with (empty) fake files. SCIFIO reads the
+  // image information from the file names.
+  itksys::SystemTools::RemoveADirectory( directory );
+  itksys::SystemTools::MakeDirectory( directory + "/sub" );
+  const char * names[] = {
+    "a&sizeX=37&sizeY=41&sizeZ=3.fake",
+    "b&sizeX=23&sizeY=90&sizeZ=1&sizeT=2&sizeC=3.fake",
+    "sub/c&sizeX=16&sizeY=16&sizeZ=11&sizeT=7&sizeC=5.fake",
+    "sub/d&sizeX=8&sizeY=8&series=3.fake"
+    };
+  for( const char * name : names )
+    {
+    std::ofstream( ( directory + "/" + name ).c_str() );
+    }
+  if( failing )
+    {
+    std::ofstream( ( directory + "/" + failingName ).c_str() );
+    }
+
+  try
+    {
+    itk::SCIFIOMetadataCatalog::Pointer catalog = itk::SCIFIOMetadataCatalog::New();
+    catalog->SetNumberOfWorkers( numberOfWorkers );
+    catalog->IndexDirectory( directory );
+    assertEquals( "probed files", ( failing ? 5 : 4 ), catalog->GetNumberOfProbedFiles() );
+    catalog->Save( catalogFileName );
+
+    // A reloaded catalog is up to date, so indexing again probes nothing
+    // but the file the bridge failed on, which is left out.
+    itk::SCIFIOMetadataCatalog::Pointer reloaded = itk::SCIFIOMetadataCatalog::New();
+    reloaded->Load( catalogFileName );
+    assertEquals( "entries", 4, reloaded->GetEntries().size() );
+    reloaded->IndexDirectory( directory );
+    assertEquals( "re-probed files", ( failing ? 1 : 0 ), reloaded->GetNumberOfProbedFiles() );
+
+    const std::string multiSeries = directory + "/" + names[3];
+    itk::SCIFIOMetadataCatalog::EntryType entry;
+    if( !reloaded->GetEntry( multiSeries, entry ) )
+      {
+      std::cerr << "[ERROR] no catalog entry for " << multiSeries << std::endl;
+      return EXIT_FAILURE;
+      }
+    assertEquals( "series count", 3, entry.Series.size() );
+
+    // The image information of cataloged files is served from the catalog.
+    itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+    io->SetCatalog( reloaded );
+    const std::string file = directory + "/" + names[2];
+    if( !io->CanReadFile( file.c_str() ) )
+      {
+      std::cerr << "[ERROR] cannot read " << file << std::endl;
+      return EXIT_FAILURE;
+      }
+    io->SetFileName( file );
+    io->ReadImageInformation();
+    assertEquals( "dimensions", 5, io->GetNumberOfDimensions() );
+    assertEquals( "sizeX", 16, io->GetDimensions( 0 ) );
+    assertEquals( "sizeZ", 11, io->GetDimensions( 2 ) );
+    assertEquals( "sizeT", 7, io->GetDimensions( 3 ) );
+    assertEquals( "sizeC", 5, io->GetDimensions( 4 ) );
+
+    // Changing a file invalidates its entry; only that file is probed again.
+    std::ofstream( ( directory + "/" + names[0] ).c_str() ) << "changed";
+    reloaded->IndexDirectory( directory );
+    assertEquals( "probed changed files", ( failing ? 2 : 1 ), reloaded->GetNumberOfProbedFiles() );
+
+    // So does rewriting a file within the same second, at the same length.
+    std::ofstream( ( directory + "/" + names[0] ).c_str() ) << "altered";
+    reloaded->IndexDirectory( directory );
+    assertEquals( "probed rewritten files", ( failing ? 2 : 1 ), reloaded->GetNumberOfProbedFiles() );
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
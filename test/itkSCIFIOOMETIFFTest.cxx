@@ -0,0 +1,263 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImage.h"
+#include "itkTimeProbe.h"
+
+#include "itksys/SystemTools.hxx"
+#include "itk_tiff.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+namespace
+{
+  // Rewrites a stripped, uncompressed TIFF file as a tiled and compressed
+  // one, IFD by IFD, keeping the OME-XML description. The bridge only
+  // writes strips. The IFD narrowIFD, if any, only keeps the left half of
+  // its plane, which the OME-XML then no longer describes.
+  bool retileTIFF( const std::string & input, const std::string & output,
+                   uint32_t tileWidth, uint32_t tileLength, uint16_t compression, long narrowIFD = -1 )
+  {
+    TIFF * in = TIFFOpen( input.c_str(), "r" );
+    if( !in )
+      {
+      return false;
+      }
+    TIFF * out = TIFFOpen( output.c_str(), "w" );
+    if( !out )
+      {
+      TIFFClose( in );
+      return false;
+      }
+
+    bool ok = true;
+    long ifd = 0;
+    do
+      {
+      uint32_t width = 0;
+      uint32_t length = 0;
+      uint16_t bitsPerSample = 1;
+      uint16_t samplesPerPixel = 1;
+      uint16_t sampleFormat = SAMPLEFORMAT_UINT;
+      uint16_t planarConfig = PLANARCONFIG_CONTIG;
+      uint16_t photometric = PHOTOMETRIC_MINISBLACK;
+      char * description = nullptr;
+      TIFFGetField( in, TIFFTAG_IMAGEWIDTH, &width );
+      TIFFGetField( in, TIFFTAG_IMAGELENGTH, &length );
+      TIFFGetFieldDefaulted( in, TIFFTAG_BITSPERSAMPLE, &bitsPerSample );
+      TIFFGetFieldDefaulted( in, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel );
+      TIFFGetFieldDefaulted( in, TIFFTAG_SAMPLEFORMAT, &sampleFormat );
+      TIFFGetFieldDefaulted( in, TIFFTAG_PLANARCONFIG, &planarConfig );
+      TIFFGetField( in, TIFFTAG_PHOTOMETRIC, &photometric );
+      if( planarConfig != PLANARCONFIG_CONTIG )
+        {
+        ok = false;
+        break;
+        }
+
+      const tmsize_t rowBytes = TIFFScanlineSize( in );
+      std::vector< unsigned char > plane( rowBytes * length );
+      for( uint32_t row = 0; ok && row < length; ++row )
+        {
+        ok = TIFFReadScanline( in, &plane[row * rowBytes], row ) >= 0;
+        }
+      const tmsize_t pixelBytes = rowBytes / width;
+      if( ifd++ == narrowIFD )
+        {
+        width /= 2;
+        }
+
+      TIFFSetField( out, TIFFTAG_IMAGEWIDTH, width );
+      TIFFSetField( out, TIFFTAG_IMAGELENGTH, length );
+      TIFFSetField( out, TIFFTAG_BITSPERSAMPLE, bitsPerSample );
+      TIFFSetField( out, TIFFTAG_SAMPLESPERPIXEL, samplesPerPixel );
+      TIFFSetField( out, TIFFTAG_SAMPLEFORMAT, sampleFormat );
+      TIFFSetField( out, TIFFTAG_PLANARCONFIG, planarConfig );
+      TIFFSetField( out, TIFFTAG_PHOTOMETRIC, photometric );
+      TIFFSetField( out, TIFFTAG_TILEWIDTH, tileWidth );
+      TIFFSetField( out, TIFFTAG_TILELENGTH, tileLength );
+      TIFFSetField( out, TIFFTAG_COMPRESSION, compression );
+      if( TIFFGetField( in, TIFFTAG_IMAGEDESCRIPTION, &description ) )
+        {
+        TIFFSetField( out, TIFFTAG_IMAGEDESCRIPTION, description );
+        }
+
+      std::vector< unsigned char > tile( TIFFTileSize( out ) );
+      for( uint32_t y = 0; ok && y < length; y += tileLength )
+        {
+        for( uint32_t x = 0; ok && x < width; x += tileWidth )
+          {
+          std::fill( tile.begin(), tile.end(), 0 );
+          const uint32_t columns = std::min( tileWidth, width - x );
+          for( uint32_t row = 0; row < tileLength && y + row < length; ++row )
+            {
+            memcpy( &tile[row * tileWidth * pixelBytes], &plane[( y + row ) * rowBytes + x * pixelBytes],
+                    columns * pixelBytes );
+            }
+          ok = TIFFWriteTile( out, &tile[0], x, y, 0, 0 ) >= 0;
+          }
+        }
+      ok = ok && TIFFWriteDirectory( out );
+      }
+    while( ok && TIFFReadDirectory( in ) );
+
+    TIFFClose( out );
+    TIFFClose( in );
+    return ok;
+  }
+}
+
+/**
+ * Writes a 5-D image as OME-TIFF with SCIFIO, optionally rewritten tiled and
+ * compressed with libtiff, then reads it back natively and through the
+ * bridge, and checks that the image information and the pixels of the whole
+ * image and of a sub-region agree. Reports the read times of both. Given an
+ * IFD to narrow in the rewrite, checks instead that the file, whose IFDs no
+ * longer all match its OME-XML, is not read natively.
+ */
+int itkSCIFIOOMETIFFTest( int argc, char * argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " output.ome.tif [tileSizeX tileSizeY [compressor [narrowIFD]]]\n";
+    return EXIT_FAILURE;
+    }
+  const std::string fileName = argv[1];
+  const itk::SizeValueType tileSizeX = argc > 3 ? atoi( argv[2] ) : 0;
+  const itk::SizeValueType tileSizeY = argc > 3 ? atoi( argv[3] ) : 0;
+  const std::string compressor = argc > 4 ? argv[4] : "";
+  const uint16_t compression = compressor == "LZW" ? COMPRESSION_LZW
+    : compressor == "DEFLATE" ? COMPRESSION_ADOBE_DEFLATE : COMPRESSION_NONE;
+  const long narrowIFD = argc > 5 ? atol( argv[5] ) : -1;
+
+  using ImageType = itk::Image< unsigned short, 5 >;
+
+  try
+    {
+    using ReaderType = itk::ImageFileReader< ImageType >;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetImageIO( itk::SCIFIOImageIO::New() );
+    reader->SetFileName( "scifioNative&sizeX=300&sizeY=200&sizeZ=5&sizeT=3&sizeC=2&pixelType=uint16.fake" );
+
+    using WriterType = itk::ImageFileWriter< ImageType >;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetImageIO( itk::SCIFIOImageIO::New() );
+    writer->SetInput( reader->GetOutput() );
+    writer->SetFileName( fileName );
+    writer->Update();
+
+    // Rewritten under the same name, which the OME-XML refers to.
+    if( tileSizeX > 0 && tileSizeY > 0 )
+      {
+      const std::string tiledFileName = fileName + ".tiled";
+      if( !retileTIFF( fileName, tiledFileName, tileSizeX, tileSizeY, compression, narrowIFD )
+          || !itksys::SystemTools::RenameFile( tiledFileName, fileName ) )
+        {
+        std::cerr << "[ERROR] cannot rewrite " << fileName << " tiled" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+
+    itk::SCIFIOOMETIFFReader::Pointer nativeReader = itk::SCIFIOOMETIFFReader::New();
+    if( narrowIFD >= 0 )
+      {
+      const bool opened = nativeReader->Open( fileName, 0 );
+      assertEquals( "file with a narrower IFD read natively", false, opened );
+      return EXIT_SUCCESS;
+      }
+    if( !nativeReader->Open( fileName, 0 ) )
+      {
+      std::cerr << "[ERROR] " << fileName << " cannot be read natively" << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    itk::SCIFIOImageIO::Pointer native = itk::SCIFIOImageIO::New();
+    native->SetFileName( fileName );
+    native->ReadImageInformation();
+    itk::SCIFIOImageIO::Pointer bridge = itk::SCIFIOImageIO::New();
+    bridge->SetUseNativeOMETIFF( false );
+    bridge->SetFileName( fileName );
+    bridge->ReadImageInformation();
+
+    assertEquals( "component type", bridge->GetComponentType(), native->GetComponentType() );
+    assertEquals( "number of components", bridge->GetNumberOfComponents(), native->GetNumberOfComponents() );
+    assertEquals( "largest region", bridge->GetXYZTCLargestPossibleRegion(), native->GetXYZTCLargestPossibleRegion() );
+    for( unsigned int i = 0; i < native->GetNumberOfDimensions(); ++i )
+      {
+      assertEquals( "size", bridge->GetDimensions( i ), native->GetDimensions( i ) );
+      assertEquals( "spacing", bridge->GetSpacing( i ), native->GetSpacing( i ) );
+      }
+
+    itk::ImageIORegion subRegion = native->GetXYZTCLargestPossibleRegion();
+    const itk::SizeValueType subSizes[] = { 101, 67, 3, 2, 1 };
+    for( unsigned int i = 0; i < 5; ++i )
+      {
+      subRegion.SetIndex( i, subRegion.GetSize( i ) - subSizes[i] );
+      subRegion.SetSize( i, subSizes[i] );
+      }
+
+    const itk::ImageIORegion regions[] = { native->GetXYZTCLargestPossibleRegion(), subRegion };
+    for( const itk::ImageIORegion & region : regions )
+      {
+      const itk::SizeValueType size = native->GetXYZTCRegionBufferSize( region );
+      std::vector< char > nativePixels( size );
+      std::vector< char > bridgePixels( size );
+
+      itk::TimeProbe nativeTime;
+      nativeTime.Start();
+      native->ReadXYZTCRegion( &nativePixels[0], region );
+      nativeTime.Stop();
+
+      itk::TimeProbe bridgeTime;
+      bridgeTime.Start();
+      bridge->ReadXYZTCRegion( &bridgePixels[0], region );
+      bridgeTime.Stop();
+
+      std::cout << "Read " << size << " bytes: native " << nativeTime.GetTotal()
+                << " s, bridge " << bridgeTime.GetTotal() << " s" << std::endl;
+      if( memcmp( &nativePixels[0], &bridgePixels[0], size ) != 0 )
+        {
+        std::cerr << "[ERROR] native and bridge reads of " << region << " differ" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
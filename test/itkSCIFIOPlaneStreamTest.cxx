@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOPlaneStream.h"
+
+#include <cstring>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Streams the planes of a fake image stored in XYCTZ order, and checks the
+ * order they come in and their pixels against direct reads of each plane.
+ * Also checks that a stream closed part way through can be opened again,
+ * and that streams over an ImageIO with a selection are turned down.
+ */
+int itkSCIFIOPlaneStreamTest( int argc, char * argv[] )
+{
+  const char * fileName = "scifioStream&sizeX=32&sizeY=16&sizeZ=3&sizeC=2&sizeT=10&dimOrder=XYCTZ.fake";
+  const unsigned int numberOfBuffers = argc > 1 ? atoi( argv[1] ) : 3;
+
+  try
+    {
+    itk::SCIFIOPlaneStream::Pointer stream = itk::SCIFIOPlaneStream::New();
+    stream->SetFileName( fileName );
+    stream->SetNumberOfBuffers( numberOfBuffers );
+
+    // Stop after a few planes, with reads still queued.
+    stream->Open();
+    for( int i = 0; i < 4 && stream->Next(); ++i )
+      {
+      }
+    stream->Close();
+
+    stream->Open();
+    assertEquals( "number of planes", 60, stream->GetNumberOfPlanes() );
+
+    itk::SCIFIOImageIO::Pointer direct = itk::SCIFIOImageIO::New();
+    direct->SetFileName( fileName );
+    direct->ReadImageInformation();
+    std::vector< char > plane( stream->GetPlaneBufferSize() );
+
+    itk::SizeValueType count = 0;
+    while( stream->Next() )
+      {
+      assertEquals( "plane number", count, stream->GetPlaneNumber() );
+      assertEquals( "c", count % 2, stream->GetC() );
+      assertEquals( "t", count / 2 % 10, stream->GetT() );
+      assertEquals( "z", count / 20, stream->GetZ() );
+
+      itk::ImageIORegion region = direct->GetXYZTCLargestPossibleRegion();
+      region.SetIndex( itk::SCIFIOImageIO::ZAxis, stream->GetZ() );
+      region.SetSize( itk::SCIFIOImageIO::ZAxis, 1 );
+      region.SetIndex( itk::SCIFIOImageIO::TAxis, stream->GetT() );
+      region.SetSize( itk::SCIFIOImageIO::TAxis, 1 );
+      region.SetIndex( itk::SCIFIOImageIO::CAxis, stream->GetC() );
+      region.SetSize( itk::SCIFIOImageIO::CAxis, 1 );
+      direct->ReadXYZTCRegion( &plane[0], region );
+      if( memcmp( stream->GetPlane(), &plane[0], plane.size() ) != 0 )
+        {
+        std::cerr << "[ERROR] streamed plane " << count << " does not match the file" << std::endl;
+        return EXIT_FAILURE;
+        }
+      ++count;
+      }
+    assertEquals( "streamed planes", 60, count );
+    stream->Close();
+
+    itk::SCIFIOImageIO::Pointer selected = itk::SCIFIOImageIO::New();
+    selected->SetStrideSelection( itk::SCIFIOImageIO::TAxis, 0, 10, 3 );
+    stream->SetImageIO( selected );
+    bool caught = false;
+    try
+      {
+      stream->Open();
+      }
+    catch( itk::ExceptionObject & )
+      {
+      caught = true;
+      }
+    if( !caught )
+      {
+      std::cerr << "[ERROR] a stream was opened over a selection" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
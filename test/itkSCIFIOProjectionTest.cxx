@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkByteSwapper.h"
+#include "itkImageFileReader.h"
+#include "itkImage.h"
+
+#include <algorithm>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Reads maximum, minimum, sum and mean projections of a fake image along
+ * each of Z, T and C, and along a selection of T, and checks them against
+ * projections computed from the whole image.
+ */
+int itkSCIFIOProjectionTest( int argc, char * argv[] )
+{
+  const char * fileName = "scifioProjection&sizeX=32&sizeY=16&sizeZ=6&sizeT=4&sizeC=3&pixelType=uint16.fake";
+  const itk::SizeValueType maximumTransferSize = argc > 1 ? std::stoull( argv[1] ) : 0;
+
+  using ImageType = itk::Image< double, 5 >;
+  using ReaderType = itk::ImageFileReader< ImageType >;
+
+  struct Projection
+  {
+    itk::SCIFIOImageIO::ProjectionType type;
+    unsigned int                       axis;
+    bool                               selectT;
+  };
+  const Projection projections[] = {
+    { itk::SCIFIOImageIO::MaximumProjection, itk::SCIFIOImageIO::ZAxis, false },
+    { itk::SCIFIOImageIO::MinimumProjection, itk::SCIFIOImageIO::ZAxis, false },
+    { itk::SCIFIOImageIO::SumProjection, itk::SCIFIOImageIO::TAxis, false },
+    { itk::SCIFIOImageIO::MeanProjection, itk::SCIFIOImageIO::CAxis, false },
+    { itk::SCIFIOImageIO::MaximumProjection, itk::SCIFIOImageIO::TAxis, true },
+    { itk::SCIFIOImageIO::MeanProjection, itk::SCIFIOImageIO::TAxis, true }
+  };
+
+  try
+    {
+    // The whole image, in native byte order.
+    itk::SCIFIOImageIO::Pointer direct = itk::SCIFIOImageIO::New();
+    direct->SetFileName( fileName );
+    direct->ReadImageInformation();
+    const itk::ImageIORegion largest = direct->GetXYZTCLargestPossibleRegion();
+    std::vector< unsigned short > pixels( largest.GetNumberOfPixels() );
+    direct->ReadXYZTCRegion( &pixels[0], largest );
+    if( direct->GetByteOrder() == itk::ImageIOBase::BigEndian )
+      {
+      itk::ByteSwapper< unsigned short >::SwapRangeFromSystemToBigEndian( &pixels[0], pixels.size() );
+      }
+    else
+      {
+      itk::ByteSwapper< unsigned short >::SwapRangeFromSystemToLittleEndian( &pixels[0], pixels.size() );
+      }
+
+    for( const Projection & projection : projections )
+      {
+      itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+      if( maximumTransferSize > 0 )
+        {
+        io->SetMaximumTransferSize( maximumTransferSize );
+        }
+      io->SetProjection( projection.type, projection.axis );
+      std::vector< itk::SizeValueType > ts( 1, 0 );
+      if( projection.selectT )
+        {
+        io->SetStrideSelection( itk::SCIFIOImageIO::TAxis, 1, 4, 2 );
+        ts = { 1, 3 };
+        }
+      else
+        {
+        ts = { 0, 1, 2, 3 };
+        }
+
+      ReaderType::Pointer reader = ReaderType::New();
+      reader->SetImageIO( io );
+      reader->SetFileName( fileName );
+      reader->Update();
+
+      const bool realValued = projection.type == itk::SCIFIOImageIO::SumProjection
+        || projection.type == itk::SCIFIOImageIO::MeanProjection;
+      const int componentType = realValued ? itk::ImageIOBase::DOUBLE : itk::ImageIOBase::USHORT;
+      assertEquals( "component type", componentType, static_cast< int >( io->GetComponentType() ) );
+
+      // Expected sizes, in XYZTC order.
+      itk::SizeValueType sizes[5];
+      for( unsigned int i = 0; i < 5; ++i )
+        {
+        sizes[i] = largest.GetSize( i );
+        }
+      sizes[itk::SCIFIOImageIO::TAxis] = ts.size();
+      sizes[projection.axis] = 1;
+
+      const ImageType::SizeType size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+      assertEquals( "number of pixels", sizes[0] * sizes[1] * sizes[2] * sizes[3] * sizes[4],
+                    reader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels() );
+      assertEquals( "sizeX", sizes[0], size[0] );
+      assertEquals( "sizeY", sizes[1], size[1] );
+
+      const double * projected = reader->GetOutput()->GetBufferPointer();
+      const itk::SizeValueType count = projection.axis == itk::SCIFIOImageIO::TAxis ? ts.size()
+                                                                                    : largest.GetSize( projection.axis );
+      itk::SizeValueType p = 0;
+      for( itk::SizeValueType c = 0; c < sizes[4]; ++c )
+        {
+        for( itk::SizeValueType t = 0; t < sizes[3]; ++t )
+          {
+          for( itk::SizeValueType z = 0; z < sizes[2]; ++z )
+            {
+            for( itk::SizeValueType xy = 0; xy < sizes[0] * sizes[1]; ++xy, ++p )
+              {
+              double expected = 0.0;
+              for( itk::SizeValueType i = 0; i < count; ++i )
+                {
+                itk::SizeValueType index[3] = { z, ts[t], c };
+                index[projection.axis - itk::SCIFIOImageIO::ZAxis] =
+                  projection.axis == itk::SCIFIOImageIO::TAxis ? ts[i] : i;
+                const double value = pixels[xy + sizes[0] * sizes[1]
+                  * ( index[0] + largest.GetSize( 2 ) * ( index[1] + largest.GetSize( 3 ) * index[2] ) )];
+                if( i == 0 || projection.type == itk::SCIFIOImageIO::SumProjection
+                    || projection.type == itk::SCIFIOImageIO::MeanProjection )
+                  {
+                  expected = i == 0 ? value : expected + value;
+                  }
+                else if( projection.type == itk::SCIFIOImageIO::MaximumProjection )
+                  {
+                  expected = std::max( expected, value );
+                  }
+                else
+                  {
+                  expected = std::min( expected, value );
+                  }
+                }
+              if( projection.type == itk::SCIFIOImageIO::MeanProjection )
+                {
+                expected /= count;
+                }
+              if( projected[p] != expected )
+                {
+                std::cerr << "[ERROR] projection " << projection.type << " along axis " << projection.axis
+                          << " is " << projected[p] << " at pixel " << p << " instead of " << expected << std::endl;
+                return EXIT_FAILURE;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,248 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImage.h"
+#include "itksys/SystemTools.hxx"
+
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Writes a fake image with sub-resolutions, tracing the exchange, and checks
+ * the sizes of the planes sent: each full-resolution plane followed by all
+ * of its sub-resolutions. With rejected, the bridge does not write
+ * sub-resolutions, as scifio-itk-bridge 1.2.1 and the SCIFIOStandInBridge
+ * with --no-resolutions, and the write must throw before any plane is sent.
+ *
+ * With keptWrites, the output file holds the pixels sent, as the
+ * SCIFIOStandInBridge keeps them with --keep-writes, and every plane of
+ * every resolution is compared with block averages of the image. Otherwise,
+ * if the file was written, its full resolution is read back and compared
+ * with the image.
+ */
+int itkSCIFIOPyramidTest( int argc, char * argv[] )
+{
+  if( argc < 5 )
+    {
+    std::cerr << "Usage: " << argv[0] << " output trace resolutions factor [keptWrites [rejected]]\n";
+    return EXIT_FAILURE;
+    }
+  const std::string outputFileName = argv[1];
+  const std::string traceFileName = argv[2];
+  const unsigned int resolutions = atoi( argv[3] );
+  const unsigned int factor = atoi( argv[4] );
+  const bool keptWrites = argc > 5 && atoi( argv[5] ) != 0;
+  const bool rejected = argc > 6 && atoi( argv[6] ) != 0;
+
+  using ImageType = itk::Image< unsigned short, 3 >;
+  const itk::SizeValueType sizeX = 301;
+  const itk::SizeValueType sizeY = 97;
+  const itk::SizeValueType sizeZ = 3;
+
+  try
+    {
+    itksys::SystemTools::RemoveFile( outputFileName );
+
+    using ReaderType = itk::ImageFileReader< ImageType >;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetImageIO( itk::SCIFIOImageIO::New() );
+    reader->SetFileName( "scifioPyramid&sizeX=301&sizeY=97&sizeZ=3&pixelType=uint16.fake" );
+    reader->Update();
+
+    itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+    io->SetNumberOfResolutions( resolutions );
+    io->SetDownsampleFactor( factor );
+    io->SetTraceFileName( traceFileName );
+
+    using WriterType = itk::ImageFileWriter< ImageType >;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetImageIO( io );
+    writer->SetInput( reader->GetOutput() );
+    writer->SetFileName( outputFileName );
+    bool thrown = false;
+    try
+      {
+      writer->Update();
+      }
+    catch( itk::ExceptionObject & e )
+      {
+      if( !rejected )
+        {
+        throw;
+        }
+      std::cout << "Rejected as expected: " << e.GetDescription() << std::endl;
+      thrown = true;
+      }
+    if( rejected && !thrown )
+      {
+      std::cerr << "[ERROR] " << resolutions << " resolutions were written by a bridge that does not write them"
+                << std::endl;
+      return EXIT_FAILURE;
+      }
+
+    io->SetTraceFileName( "" );
+
+    // The bytes of each plane sent, in order.
+    std::vector< itk::SizeValueType > planeBytes;
+    std::ifstream trace( traceFileName.c_str() );
+    std::string line;
+    while( std::getline( trace, line ) )
+      {
+      const size_t kind = line.find( '\t' ) + 1;
+      if( line.size() > kind + 1 && line[kind] == 'p' )
+        {
+        planeBytes.push_back( std::stoull( line.substr( kind + 2 ) ) );
+        }
+      }
+
+    if( rejected )
+      {
+      assertEquals( "planes sent", 0, planeBytes.size() );
+      return EXIT_SUCCESS;
+      }
+
+    const unsigned int written = static_cast< unsigned int >( planeBytes.size() / sizeZ );
+    assertEquals( "planes sent", sizeZ * resolutions, planeBytes.size() );
+    assertEquals( "resolutions written", resolutions, written );
+
+    for( itk::SizeValueType z = 0; z < sizeZ; ++z )
+      {
+      itk::SizeValueType levelX = sizeX;
+      itk::SizeValueType levelY = sizeY;
+      for( unsigned int level = 0; level < written; ++level )
+        {
+        assertEquals( "bytes of a plane", levelX * levelY * sizeof( unsigned short ),
+                      planeBytes[z * written + level] );
+        levelX = ( levelX + factor - 1 ) / factor;
+        levelY = ( levelY + factor - 1 ) / factor;
+        }
+      }
+
+    if( keptWrites )
+      {
+      // Each level averages blocks of factor x factor pixels of the level
+      // above, the blocks on the right and bottom edges being smaller, and
+      // rounds the averages to the nearest integer.
+      std::ifstream kept( outputFileName.c_str(), std::ios::binary );
+      const ImageType * image = reader->GetOutput();
+      for( itk::SizeValueType z = 0; z < sizeZ; ++z )
+        {
+        itk::SizeValueType levelX = sizeX;
+        itk::SizeValueType levelY = sizeY;
+        std::vector< unsigned short > expected( sizeX * sizeY );
+        ImageType::IndexType index;
+        index[2] = z;
+        for( index[1] = 0; index[1] < static_cast< itk::IndexValueType >( sizeY ); ++index[1] )
+          {
+          for( index[0] = 0; index[0] < static_cast< itk::IndexValueType >( sizeX ); ++index[0] )
+            {
+            expected[index[1] * sizeX + index[0]] = image->GetPixel( index );
+            }
+          }
+        for( unsigned int level = 0; level < written; ++level )
+          {
+          if( level > 0 )
+            {
+            const itk::SizeValueType aboveX = levelX;
+            const itk::SizeValueType aboveY = levelY;
+            levelX = ( aboveX + factor - 1 ) / factor;
+            levelY = ( aboveY + factor - 1 ) / factor;
+            std::vector< unsigned short > below( levelX * levelY );
+            for( itk::SizeValueType y = 0; y < levelY; ++y )
+              {
+              for( itk::SizeValueType x = 0; x < levelX; ++x )
+                {
+                double sum = 0.0;
+                unsigned int count = 0;
+                for( itk::SizeValueType j = y * factor; j < std::min( aboveY, ( y + 1 ) * factor ); ++j )
+                  {
+                  for( itk::SizeValueType i = x * factor; i < std::min( aboveX, ( x + 1 ) * factor ); ++i )
+                    {
+                    sum += expected[j * aboveX + i];
+                    ++count;
+                    }
+                  }
+                below[y * levelX + x] = static_cast< unsigned short >( std::floor( sum / count + 0.5 ) );
+                }
+              }
+            expected.swap( below );
+            }
+
+          std::vector< unsigned short > plane( levelX * levelY );
+          kept.read( reinterpret_cast< char * >( &plane[0] ), plane.size() * sizeof( unsigned short ) );
+          if( !kept )
+            {
+            std::cerr << "[ERROR] " << outputFileName << " holds too few pixels" << std::endl;
+            return EXIT_FAILURE;
+            }
+          for( itk::SizeValueType i = 0; i < plane.size(); ++i )
+            {
+            if( plane[i] != expected[i] )
+              {
+              std::cerr << "[ERROR] pixel (" << i % levelX << ", " << i / levelX << ", " << z << ") of level "
+                        << level << " does not match: expected=" << expected[i] << "; actual=" << plane[i]
+                        << std::endl;
+              return EXIT_FAILURE;
+              }
+            }
+          }
+        }
+      }
+    else if( itksys::SystemTools::FileExists( outputFileName.c_str() ) )
+      {
+      ReaderType::Pointer fileReader = ReaderType::New();
+      fileReader->SetImageIO( itk::SCIFIOImageIO::New() );
+      fileReader->SetFileName( outputFileName );
+      fileReader->Update();
+
+      assertEquals( "size", reader->GetOutput()->GetLargestPossibleRegion().GetSize(),
+                    fileReader->GetOutput()->GetLargestPossibleRegion().GetSize() );
+      itk::ImageRegionConstIterator< ImageType > expected( reader->GetOutput(),
+                                                           reader->GetOutput()->GetLargestPossibleRegion() );
+      itk::ImageRegionConstIterator< ImageType > actual( fileReader->GetOutput(),
+                                                         fileReader->GetOutput()->GetLargestPossibleRegion() );
+      for( ; !expected.IsAtEnd(); ++expected, ++actual )
+        {
+        assertEquals( "pixel", expected.Get(), actual.Get() );
+        }
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
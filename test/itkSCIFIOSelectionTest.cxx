@@ -0,0 +1,111 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImage.h"
+
+#include <cstring>
+#include <vector>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Reads channels {3, 0} and every 5th timepoint of a fake image through
+ * selections, and checks each plane against a direct read of that plane.
+ */
+int itkSCIFIOSelectionTest( int argc, char * argv[] )
+{
+  const char * fileName = "scifioSelection&sizeX=16&sizeY=8&sizeZ=5&sizeT=20&sizeC=4.fake";
+  const itk::SizeValueType maximumTransferSize = argc > 1 ? std::stoull( argv[1] ) : 0;
+
+  using PixelType = unsigned char;
+  using ImageType = itk::Image< PixelType, 5 >;
+
+  const itk::SCIFIOImageIO::IndexListType channels = { 3, 0 };
+
+  try
+    {
+    itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+    if( maximumTransferSize > 0 )
+      {
+      io->SetMaximumTransferSize( maximumTransferSize );
+      }
+    io->SetIndexSelection( itk::SCIFIOImageIO::CAxis, channels );
+    io->SetStrideSelection( itk::SCIFIOImageIO::TAxis, 0, 20, 5 );
+
+    using ReaderType = itk::ImageFileReader< ImageType >;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetImageIO( io );
+    reader->SetFileName( fileName );
+    reader->Update();
+    ImageType::Pointer image = reader->GetOutput();
+
+    const ImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+    assertEquals( "sizeZ", 5, size[2] );
+    assertEquals( "sizeT", 4, size[3] );
+    assertEquals( "sizeC", 2, size[4] );
+
+    itk::SCIFIOImageIO::Pointer direct = itk::SCIFIOImageIO::New();
+    direct->SetFileName( fileName );
+    direct->ReadImageInformation();
+    const size_t planeLength = size[0] * size[1];
+    std::vector< PixelType > plane( planeLength );
+
+    const PixelType * selected = image->GetBufferPointer();
+    for( itk::SizeValueType c = 0; c < size[4]; ++c )
+      {
+      for( itk::SizeValueType t = 0; t < size[3]; ++t )
+        {
+        for( itk::SizeValueType z = 0; z < size[2]; ++z, selected += planeLength )
+          {
+          itk::ImageIORegion region = direct->GetXYZTCLargestPossibleRegion();
+          region.SetIndex( 2, z );
+          region.SetSize( 2, 1 );
+          region.SetIndex( 3, t * 5 );
+          region.SetSize( 3, 1 );
+          region.SetIndex( 4, channels[c] );
+          region.SetSize( 4, 1 );
+          direct->ReadXYZTCRegion( &plane[0], region );
+          if( memcmp( selected, &plane[0], planeLength ) != 0 )
+            {
+            std::cerr << "[ERROR] selected plane (z=" << z << ", t=" << t << ", c=" << c
+                      << ") does not match plane (z=" << z << ", t=" << t * 5 << ", c=" << channels[c]
+                      << ") of the file" << std::endl;
+            return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
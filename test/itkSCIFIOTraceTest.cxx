@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImage.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+
+#define assertEquals(name, expected, actual)                \
+  {                                                         \
+  if( expected != actual )                                  \
+    {                                                       \
+    std::cerr << "[ERROR] " << name << " does not match: "  \
+                 "expected=" << expected << "; "            \
+                 "actual=" << actual << std::endl;          \
+    return EXIT_FAILURE;                                    \
+    }                                                       \
+  }
+
+/**
+ * Records the exchanges of a read and a write with the bridge to a trace,
+ * checks what was recorded, and replays the trace.
+ *
+ * With a trace file only, the trace is replayed against the bridge, e.g. to
+ * compare a trace recorded elsewhere with a run on this machine:
+ *   SCIFIOTestDriver itkSCIFIOTraceTest trace.txt
+ * Setting SCIFIO_BRIDGE_COMMAND to the SCIFIOStandInBridge program replays
+ * it without Java.
+ */
+int itkSCIFIOTraceTest( int argc, char * argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " trace [output]\n";
+    return EXIT_FAILURE;
+    }
+  const std::string traceFileName = argv[1];
+
+  try
+    {
+    if( argc > 2 )
+      {
+      using ImageType = itk::Image< unsigned short, 3 >;
+
+      itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+      io->SetTraceFileName( traceFileName );
+
+      using ReaderType = itk::ImageFileReader< ImageType >;
+      ReaderType::Pointer reader = ReaderType::New();
+      reader->SetImageIO( io );
+      reader->SetFileName( "scifioTrace&sizeX=64&sizeY=32&sizeZ=4&pixelType=uint16.fake" );
+
+      using WriterType = itk::ImageFileWriter< ImageType >;
+      WriterType::Pointer writer = WriterType::New();
+      writer->SetImageIO( io );
+      writer->SetInput( reader->GetOutput() );
+      writer->SetFileName( argv[2] );
+      writer->Update();
+
+      io->SetTraceFileName( "" );
+
+      // Count the events of each kind.
+      std::map< char, unsigned int > events;
+      std::ifstream trace( traceFileName.c_str() );
+      std::string line;
+      std::getline( trace, line );
+      assertEquals( "header", "SCIFIOTrace\t1", line );
+      while( std::getline( trace, line ) )
+        {
+        ++events[line[line.find( '\t' ) + 1]];
+        }
+      if( events['s'] == 0 || events['>'] == 0 || events['<'] == 0 )
+        {
+        std::cerr << "[ERROR] the process start, commands or replies were not recorded" << std::endl;
+        return EXIT_FAILURE;
+        }
+      assertEquals( "data replies", 1, events['d'] );
+      assertEquals( "planes written", 4, events['p'] );
+      assertEquals( "images written", 1, events['e'] );
+      }
+
+    // Replay with an IO of its own, which starts its own process.
+    itk::SCIFIOImageIO::Pointer replayIO = itk::SCIFIOImageIO::New();
+    const itk::SizeValueType exchanges = replayIO->ReplayTrace( traceFileName, std::cout );
+    std::cout << "Replayed " << exchanges << " exchanges" << std::endl;
+    if( exchanges == 0 )
+      {
+      std::cerr << "[ERROR] nothing was replayed" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
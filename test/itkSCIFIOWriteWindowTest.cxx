@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright Insight Software Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkSCIFIOImageIO.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImage.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+/**
+ * Writes a fake image to the SCIFIOStandInBridge, run with --keep-writes,
+ * waiting for the acknowledgement of each chunk and with chunks sent ahead
+ * of the acknowledgements, and reports the throughput of both. The pixels
+ * the bridge received must match the image either way, and sending ahead
+ * must not be slower than waiting for each chunk.
+ *
+ *   SCIFIOTestDriver itkSCIFIOWriteWindowTest output [windowSize [runs]]
+ */
+int itkSCIFIOWriteWindowTest( int argc, char * argv[] )
+{
+  if( argc < 2 )
+    {
+    std::cerr << "Usage: " << argv[0] << " output [windowSize [runs]]\n";
+    return EXIT_FAILURE;
+    }
+  const std::string outputFileName = argv[1];
+  const unsigned int windowSize = argc > 2 ? atoi( argv[2] ) : 16;
+  const unsigned int runs = argc > 3 ? atoi( argv[3] ) : 3;
+
+  using PixelType = unsigned short;
+  using ImageType = itk::Image< PixelType, 3 >;
+
+  try
+    {
+    using ReaderType = itk::ImageFileReader< ImageType >;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetImageIO( itk::SCIFIOImageIO::New() );
+    reader->SetFileName( "scifioWindow&sizeX=2048&sizeY=2048&sizeZ=4&pixelType=uint16.fake" );
+    reader->Update();
+    const ImageType * image = reader->GetOutput();
+    const itk::SizeValueType bytes = image->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof( PixelType );
+
+    std::cout << std::left << std::setw( 12 ) << "Window" << std::right << std::setw( 16 ) << "Write (MB/s)"
+              << std::endl;
+
+    double throughputs[2] = { 0.0, 0.0 };
+    const unsigned int windowSizes[2] = { 1, windowSize };
+    for( unsigned int i = 0; i < 2; ++i )
+      {
+      for( unsigned int run = 0; run < runs; ++run )
+        {
+        itk::SCIFIOImageIO::Pointer io = itk::SCIFIOImageIO::New();
+        io->SetWriteWindowSize( windowSizes[i] );
+
+        using WriterType = itk::ImageFileWriter< ImageType >;
+        WriterType::Pointer writer = WriterType::New();
+        writer->SetImageIO( io );
+        writer->SetInput( image );
+        writer->SetFileName( outputFileName );
+
+        itk::TimeProbe probe;
+        probe.Start();
+        writer->Update();
+        probe.Stop();
+        throughputs[i] = std::max( throughputs[i], bytes / probe.GetTotal() / 1e6 );
+
+        std::vector< char > received( bytes + 1 );
+        std::ifstream kept( outputFileName.c_str(), std::ios::binary );
+        kept.read( &received[0], received.size() );
+        if( static_cast< itk::SizeValueType >( kept.gcount() ) != bytes
+            || !std::equal( received.begin(), received.begin() + bytes,
+                            reinterpret_cast< const char * >( image->GetBufferPointer() ) ) )
+          {
+          std::cerr << "[ERROR] the pixels received with a window of " << windowSizes[i]
+                    << " chunks do not match the image" << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      std::cout << std::left << std::setw( 12 ) << windowSizes[i] << std::right << std::setw( 16 )
+                << throughputs[i] << std::endl;
+      }
+
+    // The best of several runs, with some slack for noisy machines.
+    if( throughputs[1] < 0.9 * throughputs[0] )
+      {
+      std::cerr << "[ERROR] sending ahead is slower than waiting for each chunk" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+// Python-only extensions of itk::SCIFIOImageIO: read regions of a series
+// straight into NumPy arrays, without an intermediate itk::Image.
+
+%{
+#include "itkMetaDataObject.h"
+%}
+
+%extend itkSCIFIOImageIO {
+  // Returns ((sizeX, sizeY, sizeZ, sizeT, sizeC), rgbChannelCount, dtype)
+  // of the current series, dtype being the NumPy type string of the
+  // samples in the file, in the file's byte order.
+  PyObject * _GetXYZTCLayout()
+    {
+    itk::ImageIORegion largest;
+    try
+      {
+      largest = $self->GetXYZTCLargestPossibleRegion();
+      }
+    catch( const itk::ExceptionObject & e )
+      {
+      PyErr_SetString( PyExc_RuntimeError, e.what() );
+      return NULL;
+      }
+
+    // The samples come as typed in the file, whatever component type a
+    // projection reports, so the dtype follows the SCIFIO metadata.
+    const itk::MetaDataDictionary & dict = $self->GetMetaDataDictionary();
+    std::string pixelType;
+    std::string littleEndian;
+    if( !itk::ExposeMetaData< std::string >( dict, "PixelType", pixelType )
+        || !itk::ExposeMetaData< std::string >( dict, "LittleEndian", littleEndian ) )
+      {
+      PyErr_SetString( PyExc_RuntimeError, "ReadImageInformation must be called first" );
+      return NULL;
+      }
+    // SCIFIO's pixel types, INT8 to DOUBLE.
+    const char * const dtypes[] = { "i1", "u1", "i2", "u2", "i4", "u4", "f4", "f8" };
+    const int type = atoi( pixelType.c_str() );
+    if( type < 0 || type >= 8 )
+      {
+      PyErr_Format( PyExc_RuntimeError, "unsupported SCIFIO pixel type %s", pixelType.c_str() );
+      return NULL;
+      }
+    const bool isLittleEndian = littleEndian == "true" || littleEndian == "1";
+    char dtype[16];
+    snprintf( dtype, sizeof( dtype ), "%s%s", isLittleEndian ? "<" : ">", dtypes[type] );
+
+    return Py_BuildValue( "((nnnnn)Is)",
+                          static_cast< Py_ssize_t >( largest.GetSize(0) ),
+                          static_cast< Py_ssize_t >( largest.GetSize(1) ),
+                          static_cast< Py_ssize_t >( largest.GetSize(2) ),
+                          static_cast< Py_ssize_t >( largest.GetSize(3) ),
+                          static_cast< Py_ssize_t >( largest.GetSize(4) ),
+                          $self->GetNumberOfComponents(), dtype );
+    }
+
+  // Reads the XYZTC region given as a sequence of (start, size) pairs into
+  // out, a writable C-contiguous buffer, or into a new bytearray if out is
+  // None. Returns the buffer that was filled. The file is read as is, so
+  // selections and projections are turned down rather than ignored.
+  PyObject * _ReadXYZTCRegion( PyObject * startsAndSizes, PyObject * out )
+    {
+    if( !$self->GetIndexSelection( itk::SCIFIOImageIO::ZAxis ).empty()
+        || !$self->GetIndexSelection( itk::SCIFIOImageIO::TAxis ).empty()
+        || !$self->GetIndexSelection( itk::SCIFIOImageIO::CAxis ).empty()
+        || $self->GetProjection() != itk::SCIFIOImageIO::NoProjection )
+      {
+      PyErr_SetString( PyExc_ValueError, "ReadRegion reads the file as is: clear the selections and projection first" );
+      return NULL;
+      }
+    itk::ImageIORegion largest;
+    try
+      {
+      largest = $self->GetXYZTCLargestPossibleRegion();
+      }
+    catch( const itk::ExceptionObject & e )
+      {
+      PyErr_SetString( PyExc_RuntimeError, e.what() );
+      return NULL;
+      }
+
+    itk::ImageIORegion region(5);
+    bool empty = false;
+    PyObject * seq = PySequence_Fast( startsAndSizes, "expected a sequence of (start, size) pairs" );
+    if( seq == NULL )
+      {
+      return NULL;
+      }
+    if( PySequence_Fast_GET_SIZE( seq ) != 5 )
+      {
+      Py_DECREF( seq );
+      PyErr_SetString( PyExc_ValueError, "expected 5 (start, size) pairs, in XYZTC order" );
+      return NULL;
+      }
+    for( unsigned int i = 0; i < 5; ++i )
+      {
+      Py_ssize_t start = 0;
+      Py_ssize_t size = 0;
+      if( !PyArg_ParseTuple( PySequence_Fast_GET_ITEM( seq, i ), "nn", &start, &size ) )
+        {
+        Py_DECREF( seq );
+        return NULL;
+        }
+      // Checked before anything is sized from them, as negative values
+      // would wrap around to huge unsigned ones.
+      const Py_ssize_t axisSize = static_cast< Py_ssize_t >( largest.GetSize(i) );
+      if( start < 0 || size < 0 || start > axisSize || size > axisSize - start )
+        {
+        Py_DECREF( seq );
+        PyErr_Format( PyExc_ValueError, "%zd pixels from %zd along axis %c are outside of its %zd pixels",
+                      size, start, "XYZTC"[i], axisSize );
+        return NULL;
+        }
+      region.SetIndex( i, start );
+      region.SetSize( i, size );
+      empty = empty || size == 0;
+      }
+    Py_DECREF( seq );
+
+    const size_t byteCount = empty ? 0 : $self->GetXYZTCRegionBufferSize( region );
+
+    PyObject * result = NULL;
+    Py_buffer view;
+    if( out == Py_None )
+      {
+      result = PyByteArray_FromStringAndSize( NULL, static_cast< Py_ssize_t >( byteCount ) );
+      if( result == NULL )
+        {
+        return NULL;
+        }
+      if( PyObject_GetBuffer( result, &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS ) != 0 )
+        {
+        Py_DECREF( result );
+        return NULL;
+        }
+      }
+    else
+      {
+      if( PyObject_GetBuffer( out, &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS ) != 0 )
+        {
+        return NULL;
+        }
+      if( static_cast< size_t >( view.len ) != byteCount )
+        {
+        PyBuffer_Release( &view );
+        PyErr_Format( PyExc_ValueError, "output buffer holds %zd bytes, the region needs %zu",
+                      view.len, byteCount );
+        return NULL;
+        }
+      Py_INCREF( out );
+      result = out;
+      }
+
+    if( empty )
+      {
+      PyBuffer_Release( &view );
+      return result;
+      }
+
+    // Decoding happens in Java; let other Python threads run meanwhile.
+    std::string error;
+    Py_BEGIN_ALLOW_THREADS
+    try
+      {
+      $self->ReadXYZTCRegion( view.buf, region );
+      }
+    catch( const itk::ExceptionObject & e )
+      {
+      error = e.what();
+      }
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release( &view );
+    if( !error.empty() )
+      {
+      Py_DECREF( result );
+      PyErr_SetString( PyExc_RuntimeError, error.c_str() );
+      return NULL;
+      }
+    return result;
+    }
+
+  %pythoncode %{
+    def ReadRegion(self, series=0, x=None, y=None, z=None, t=None, c=None, out=None):
+        """Read a region of a series directly into a NumPy array.
+
+        Each of x, y, z, t and c is None for the whole axis, an integer
+        (Python or NumPy) for a single index, or a (start, stop) pair. The
+        result has the shape (c, t, z, y, x), with a trailing component axis
+        for RGB and vector data, and the pixel type of the file. It views
+        the buffer the pixels were read into: there is no intermediate
+        itk.Image and no extra copy.
+
+        The file is read as is: ValueError is raised if the region is not
+        within the series, or if a selection or projection is set.
+
+        If out is given, it must be a writable, C-contiguous array of that
+        shape and dtype; the pixels are read into it and it is returned.
+        """
+        import numbers
+        import numpy as np
+
+        if series != self.GetSeries():
+            self.SetSeries(series)
+            self.ReadImageInformation()
+        sizes, components, dtype = self._GetXYZTCLayout()
+
+        startsAndSizes = []
+        for selection, size in zip((x, y, z, t, c), sizes):
+            if selection is None:
+                startsAndSizes.append((0, size))
+            elif isinstance(selection, numbers.Integral):
+                startsAndSizes.append((selection, 1))
+            else:
+                start, stop = selection
+                startsAndSizes.append((start, stop - start))
+
+        shape = tuple(size for _, size in reversed(startsAndSizes))
+        if components > 1:
+            shape += (components,)
+
+        if out is None:
+            buffer = self._ReadXYZTCRegion(startsAndSizes, None)
+            return np.frombuffer(buffer, dtype=dtype).reshape(shape)
+
+        if out.shape != shape or out.dtype != np.dtype(dtype):
+            raise ValueError("out must have shape %s and dtype %s" % (shape, np.dtype(dtype)))
+        self._ReadXYZTCRegion(startsAndSizes, out)
+        return out
+  %}
+}
@@ -0,0 +1,85 @@
+#==========================================================================
+#
+#   Copyright Insight Software Consortium
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#          http://www.apache.org/licenses/LICENSE-2.0.txt
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+#
+#==========================================================================*/
+
+# Reads sub-regions of a .fake image with SCIFIOImageIO.ReadRegion, and
+# checks their shape, dtype and values against the whole image, read through
+# an itk.ImageFileReader. Regions outside of the image, and reads with a
+# selection or projection set, must raise ValueError.
+
+import os
+import sys
+
+import itk
+import numpy as np
+
+if len(sys.argv) < 2:
+    print("Usage: " + sys.argv[0] + " outputDirectory")
+    sys.exit(1)
+
+# SCIFIO reads the image information from the file name.
+fileName = os.path.join(sys.argv[1], "scifioReadRegion&sizeX=64&sizeY=48&sizeZ=5&pixelType=uint16.fake")
+open(fileName, "w").close()
+
+ImageType = itk.Image[itk.US, 3]
+reader = itk.ImageFileReader[ImageType].New(FileName=fileName, ImageIO=itk.SCIFIOImageIO.New())
+reader.Update()
+expected = itk.GetArrayFromImage(reader.GetOutput())
+assert expected.shape == (5, 48, 64), expected.shape
+
+io = itk.SCIFIOImageIO.New()
+io.SetFileName(fileName)
+io.ReadImageInformation()
+
+region = io.ReadRegion(x=(8, 40), y=(4, 20), z=(1, 4))
+assert region.shape == (1, 1, 3, 16, 32), region.shape
+assert region.dtype.kind == "u" and region.dtype.itemsize == 2, region.dtype
+assert np.array_equal(region[0, 0], expected[1:4, 4:20, 8:40])
+
+plane = io.ReadRegion(z=np.int64(2))
+assert plane.shape == (1, 1, 1, 48, 64), plane.shape
+assert np.array_equal(plane[0, 0, 0], expected[2])
+
+out = np.zeros((1, 1, 2, 48, 64), dtype=region.dtype)
+filled = io.ReadRegion(z=(3, 5), out=out)
+assert filled is out
+assert np.array_equal(out[0, 0], expected[3:5])
+
+empty = io.ReadRegion(x=(10, 10))
+assert empty.shape == (1, 1, 5, 48, 0), empty.shape
+
+
+def assertRaisesValueError(description, read):
+    try:
+        read()
+    except ValueError:
+        return
+    raise AssertionError(description + " did not raise ValueError")
+
+
+assertRaisesValueError("a negative size", lambda: io.ReadRegion(x=(40, 8)))
+assertRaisesValueError("a negative start", lambda: io.ReadRegion(z=-1))
+assertRaisesValueError("a region past the end", lambda: io.ReadRegion(y=(0, 49)))
+assertRaisesValueError("an index past the end", lambda: io.ReadRegion(z=5))
+
+io.SetStrideSelection(2, 0, 5, 2)
+assertRaisesValueError("a read with a selection", lambda: io.ReadRegion(z=0))
+io.ClearSelections()
+io.SetProjection(itk.SCIFIOImageIO.MaximumProjection, 2)
+assertRaisesValueError("a read with a projection", lambda: io.ReadRegion(z=0))
+io.SetProjection(itk.SCIFIOImageIO.NoProjection, 2)
+assert np.array_equal(io.ReadRegion(z=0)[0, 0, 0], expected[0])